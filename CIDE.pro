@@ -1,4 +1,4 @@
-QT       += core gui    network
+QT       += core gui    network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 CONFIG += c++11
@@ -9,13 +9,65 @@ CONFIG += c++11
 
 SOURCES += \
     CppHighlighter.cpp \
+    aicache.cpp \
+    aiclient.cpp \
+    blockstatecache.cpp \
+    completionindex.cpp \
+    completiontrie.cpp \
+    contextbuilder.cpp \
+    conversationhistory.cpp \
+    debugpanel.cpp \
+    debugsession.cpp \
+    diffreview.cpp \
+    filesaver.cpp \
+    fontservice.cpp \
+    gdbmi.cpp \
+    gutterrenderer.cpp \
+    inlinecompletion.cpp \
+    linediff.cpp \
+    lspclient.cpp \
     main.cpp \
+    markdownstream.cpp \
     mainwindow.cpp\
+    minimap.cpp \
+    recoveryjournal.cpp \
+    sessionstore.cpp \
+    sseparser.cpp \
+    startupprofiler.cpp \
+    syntaxchecker.cpp \
+    textfile.cpp \
     codeeditor.cpp\
 
 HEADERS += \
     CppHighlighter.h \
+    aicache.h \
+    aiclient.h \
+    blockdata.h \
+    blockstatecache.h \
+    completionindex.h \
+    completiontrie.h \
+    contextbuilder.h \
+    conversationhistory.h \
+    debugpanel.h \
+    debugsession.h \
+    diffreview.h \
+    diagnostic.h \
+    filesaver.h \
+    fontservice.h \
+    gdbmi.h \
+    gutterrenderer.h \
+    inlinecompletion.h \
+    linediff.h \
+    lspclient.h \
+    markdownstream.h \
     mainwindow.h\
+    minimap.h \
+    recoveryjournal.h \
+    sessionstore.h \
+    sseparser.h \
+    startupprofiler.h \
+    syntaxchecker.h \
+    textfile.h \
     codeeditor.h\
 
 
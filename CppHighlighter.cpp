@@ -1,77 +1,128 @@
 #include "CppHighlighter.h"
+#include "blockdata.h"
+#include "completionindex.h"
 #include <QTextDocument>
+#include <QTextBlock>
+#include <QSet>
+#include <QTimer>
 
-CppHighlighter::CppHighlighter(QTextDocument *parent)
-    : QSyntaxHighlighter(parent)
+// ----------------- 共享规则表 -----------------
+HighlightingTheme::HighlightingTheme()
 {
     // ----------------- 关键字 -----------------
-    QStringList keywordPatterns = {
-        "\\bif\\b", "\\belse\\b", "\\bfor\\b", "\\bwhile\\b",
-        "\\breturn\\b", "\\bbreak\\b", "\\bcontinue\\b", "\\bswitch\\b",
-        "\\bcase\\b", "\\bdefault\\b", "\\bdo\\b", "\\bconst\\b",
-        "\\bstatic\\b", "\\bextern\\b", "\\bnamespace\\b", "\\bclass\\b",
-        "\\bconstexpr\\b", "\\bnullptr\\b", "\\bauto\\b", "\\boverride\\b",
-        "\\bfinal\\b", "\\bnoexcept\\b", "\\btemplate\\b"
+    // 同类单词合成一个交替表达式，每块只需扫描一遍
+    const QStringList keywords = {
+        "if", "else", "for", "while", "return", "break", "continue", "switch",
+        "case", "default", "do", "const", "static", "extern", "namespace", "class",
+        "constexpr", "nullptr", "auto", "override", "final", "noexcept", "template"
     };
     keywordFormat.setForeground(Qt::blue);
     keywordFormat.setFontWeight(QFont::Bold);
-    for (const QString &pattern : keywordPatterns)
-        highlightingRules.append({QRegularExpression(pattern), keywordFormat});
+    rules.append({QRegularExpression("\\b(?:" + keywords.join('|') + ")\\b"), keywordFormat});
 
     // ----------------- 类型 -----------------
-    QStringList typePatterns = {"\\bint\\b", "\\bfloat\\b", "\\bdouble\\b",
-                                "\\bchar\\b", "\\bbool\\b", "\\bvoid\\b", "\\bshort\\b",
-                                "\\blong\\b", "\\bsigned\\b", "\\bunsigned\\b"};
+    const QStringList types = {"int", "float", "double", "char", "bool", "void", "short",
+                               "long", "signed", "unsigned"};
     typeFormat.setForeground(Qt::darkMagenta);
     typeFormat.setFontWeight(QFont::Bold);
-    for (const QString &pattern : typePatterns)
-        highlightingRules.append({QRegularExpression(pattern), typeFormat});
+    rules.append({QRegularExpression("\\b(?:" + types.join('|') + ")\\b"), typeFormat});
 
     // ----------------- 函数名 -----------------
     functionFormat.setForeground(Qt::darkCyan);
-    highlightingRules.append({QRegularExpression("\\b[A-Za-z_][A-Za-z0-9_]*(?=\\()"), functionFormat});
+    rules.append({QRegularExpression("\\b[A-Za-z_][A-Za-z0-9_]*(?=\\()"), functionFormat});
 
     // ----------------- 字符串/字符 -----------------
     stringFormat.setForeground(Qt::red);
+    stringPattern = QRegularExpression("\"(\\\\.|[^\"])*\"|'(\\\\.|[^'])*'");
 
     // ----------------- 数字 -----------------
     numberFormat.setForeground(Qt::darkYellow);
-    highlightingRules.append({QRegularExpression("\\b[0-9]+(\\.[0-9]+)?\\b"), numberFormat});
-    highlightingRules.append({QRegularExpression("\\b0x[0-9A-Fa-f]+\\b"), numberFormat});
+    rules.append({QRegularExpression("\\b[0-9]+(\\.[0-9]+)?\\b"), numberFormat});
+    rules.append({QRegularExpression("\\b0x[0-9A-Fa-f]+\\b"), numberFormat});
 
     // ----------------- 宏 / 预处理指令 -----------------
     preprocessorFormat.setForeground(Qt::darkRed);
     preprocessorFormat.setFontWeight(QFont::Bold);
-    highlightingRules.append({QRegularExpression("^#\\s*\\w+"), preprocessorFormat});
+    rules.append({QRegularExpression("^#\\s*\\w+"), preprocessorFormat});
 
     // ----------------- 单行注释 -----------------
     singleLineCommentFormat.setForeground(Qt::darkGreen);
     singleLineCommentFormat.setFontItalic(true);
-    highlightingRules.append({QRegularExpression("//[^\n]*"), singleLineCommentFormat});
+    rules.append({QRegularExpression("//[^\n]*"), singleLineCommentFormat});
 
     // ----------------- 多行注释 -----------------
     multiLineCommentFormat.setForeground(Qt::darkGreen);
     multiLineCommentFormat.setFontItalic(true);
     commentStartExpression = QRegularExpression("/\\*");
     commentEndExpression = QRegularExpression("\\*/");
+
+    // ----------------- 语义记号（来自 clangd） -----------------
+    QTextCharFormat userType;
+    userType.setForeground(QColor(0x26, 0x7f, 0x99));
+    for (const char *type : {"class", "struct", "enum", "type", "typeParameter", "interface"})
+        semanticFormats.insert(QString::fromLatin1(type), userType);
+    semanticFormats.insert("macro", preprocessorFormat);
+    QTextCharFormat enumMember;
+    enumMember.setForeground(Qt::darkYellow);
+    semanticFormats.insert("enumMember", enumMember);
+    QTextCharFormat parameter;
+    parameter.setFontItalic(true);
+    semanticFormats.insert("parameter", parameter);
+    QTextCharFormat nameSpace;
+    nameSpace.setForeground(Qt::darkGray);
+    semanticFormats.insert("namespace", nameSpace);
+
+    // 立即编译（并在支持时 JIT），避免第一次高亮时才付出编译代价
+    for (HighlightingRule &rule : rules)
+        rule.pattern.optimize();
+    stringPattern.optimize();
+    commentStartExpression.optimize();
+    commentEndExpression.optimize();
+}
+
+const HighlightingTheme &HighlightingTheme::shared()
+{
+    static const HighlightingTheme theme;
+    return theme;
+}
+
+CppHighlighter::CppHighlighter(QTextDocument *parent)
+    : QSyntaxHighlighter(parent), theme(HighlightingTheme::shared())
+{
 }
 
 void CppHighlighter::highlightBlock(const QString &text)
 {
+    // ----------------- 缓存的块状态（会话恢复） -----------------
+    if (!cachedStates.isEmpty()) {
+        const QTextBlock block = currentBlock();
+        const int number = block.blockNumber();
+        // 只有前一块的状态与缓存一致时才可信，否则退回完整高亮
+        if (number < cachedStates.size() &&
+            (number == 0 || previousBlockState() == cachedStates.at(number - 1))) {
+            setCurrentBlockState(cachedStates.at(number));
+            if (!block.next().isValid()) {
+                cachedStates.clear();
+                QMetaObject::invokeMethod(this, &CppHighlighter::cachedStatesApplied, Qt::QueuedConnection);
+            }
+            return;
+        }
+        cachedStates.clear();
+        QMetaObject::invokeMethod(this, &CppHighlighter::cachedStatesApplied, Qt::QueuedConnection);
+    }
+
     // ----------------- 字符串处理 -----------------
     QVector<bool> isInString(text.length(), false);
-    QRegularExpression stringPattern("\"(\\\\.|[^\"])*\"|'(\\\\.|[^'])*'");
-    QRegularExpressionMatchIterator stringIt = stringPattern.globalMatch(text);
+    QRegularExpressionMatchIterator stringIt = theme.stringPattern.globalMatch(text);
     while (stringIt.hasNext()) {
         QRegularExpressionMatch match = stringIt.next();
         for (int i = match.capturedStart(); i < match.capturedStart() + match.capturedLength(); ++i)
             isInString[i] = true;
-        setFormat(match.capturedStart(), match.capturedLength(), stringFormat);
+        setFormat(match.capturedStart(), match.capturedLength(), theme.stringFormat);
     }
 
     // ----------------- 单行规则 -----------------
-    for (const HighlightingRule &rule : highlightingRules) {
-        if (&rule.format == &stringFormat) continue;
+    for (const HighlightingRule &rule : theme.rules) {
         QRegularExpressionMatchIterator matchIterator = rule.pattern.globalMatch(text);
         while (matchIterator.hasNext()) {
             QRegularExpressionMatch match = matchIterator.next();
@@ -85,27 +136,231 @@ void CppHighlighter::highlightBlock(const QString &text)
     }
 
     // ----------------- 多行注释 -----------------
-    setCurrentBlockState(0);
     int startIndex = 0;
-    if (previousBlockState() != 1)
-        startIndex = text.indexOf(commentStartExpression);
+    if (!stateInComment(previousBlockState()))
+        startIndex = text.indexOf(theme.commentStartExpression);
 
     while (startIndex >= 0) {
         if (startIndex < isInString.size() && isInString[startIndex]) {
-            startIndex = text.indexOf(commentStartExpression, startIndex + 1);
+            startIndex = text.indexOf(theme.commentStartExpression, startIndex + 1);
             continue;
         }
 
         QRegularExpressionMatch endMatch;
-        int endIndex = text.indexOf(commentEndExpression, startIndex, &endMatch);
+        int endIndex = text.indexOf(theme.commentEndExpression, startIndex, &endMatch);
         int commentLength;
         if (endIndex == -1) {
-            setCurrentBlockState(1);
             commentLength = text.length() - startIndex;
         } else {
             commentLength = endIndex - startIndex + endMatch.capturedLength();
         }
-        setFormat(startIndex, commentLength, multiLineCommentFormat);
-        startIndex = text.indexOf(commentStartExpression, startIndex + commentLength);
+        setFormat(startIndex, commentLength, theme.multiLineCommentFormat);
+        startIndex = text.indexOf(theme.commentStartExpression, startIndex + commentLength);
+    }
+
+    // ----------------- 嵌套结构（折叠） -----------------
+    BlockData *data = static_cast<BlockData*>(currentBlockUserData());
+    if (!data) {
+        data = new BlockData;
+        setCurrentBlockUserData(data);
+    }
+
+    const int previousState = previousBlockState();
+    int minBraceDepth = 0;
+    const int state = computeNesting(text, isInString, previousState, &minBraceDepth);
+    setCurrentBlockState(state);
+    data->minBraceDepth = minBraceDepth;
+
+    if (!stateInComment(previousState) && stateInComment(state))
+        data->foldKind = BlockData::CommentFold;
+    else if (statePreprocessorDepth(state) > statePreprocessorDepth(previousState))
+        data->foldKind = BlockData::PreprocessorFold;
+    else if (stateBraceDepth(state) > minBraceDepth)
+        data->foldKind = BlockData::BraceFold;
+    else
+        data->foldKind = BlockData::NoFold;
+
+    // ----------------- 标识符索引（供补全使用） -----------------
+    const QStringList identifiers = CompletionIndex::extractIdentifiers(text, isInString);
+    if (identifiers != data->identifiers) {
+        CompletionIndex::instance()->replaceWords(data->identifiers, identifiers);
+        data->identifiers = identifiers;
+    }
+
+    // ----------------- 语义记号（来自 clangd） -----------------
+    const auto tokensIt = semanticTokens.constFind(currentBlock().blockNumber());
+    if (tokensIt != semanticTokens.constEnd()) {
+        for (const SemanticToken &token : tokensIt.value()) {
+            if (token.column + token.length > text.length()) continue;   // 文本已变化，等待下一次刷新
+            const auto format = theme.semanticFormats.constFind(token.type);
+            if (format != theme.semanticFormats.constEnd())
+                setFormat(token.column, token.length, format.value());
+        }
+    }
+
+    // ----------------- 小地图颜色摘要 -----------------
+    updateColorRuns(text);
+}
+
+void CppHighlighter::updateColorRuns(const QString &text)
+{
+    const int tabWidth = 4;
+    auto colorAt = [this](int i) -> QRgb {
+        const QBrush brush = format(i).foreground();
+        return brush.style() == Qt::NoBrush ? qRgb(0, 0, 0) : brush.color().rgb();
+    };
+
+    QVector<BlockData::ColorRun> runs;
+    int column = 0;
+    int i = 0;
+    while (i < text.length()) {
+        const QChar c = text.at(i);
+        if (c.isSpace()) {
+            column = (c == '\t') ? (column / tabWidth + 1) * tabWidth : column + 1;
+            ++i;
+            continue;
+        }
+
+        const QRgb color = colorAt(i);
+        const int start = column;
+        while (i < text.length() && !text.at(i).isSpace() && colorAt(i) == color) {
+            ++column;
+            ++i;
+        }
+        runs.append({start, column - start, color});
+    }
+
+    BlockData *data = static_cast<BlockData*>(currentBlockUserData());
+    if (data && runs != data->colorRuns) {
+        data->colorRuns = runs;
+        emit blockColorsChanged(currentBlock().blockNumber());
+    }
+}
+
+int CppHighlighter::computeNesting(const QString &text, const QVector<bool> &isInString,
+                                   int previousState, int *minBraceDepth) const
+{
+    bool inComment = stateInComment(previousState);
+    int preprocessorDepth = statePreprocessorDepth(previousState);
+    int braceDepth = stateBraceDepth(previousState);
+    *minBraceDepth = braceDepth;
+
+    // 预处理条件块：#if / #ifdef / #ifndef 进入，#endif 退出
+    if (!inComment) {
+        const QString trimmed = text.trimmed();
+        if (trimmed.startsWith('#')) {
+            int begin = 1;
+            while (begin < trimmed.length() && trimmed.at(begin).isSpace()) ++begin;
+            int end = begin;
+            while (end < trimmed.length() && trimmed.at(end).isLetter()) ++end;
+            const QStringView directive = QStringView(trimmed).mid(begin, end - begin);
+            if (directive == QLatin1String("if") || directive == QLatin1String("ifdef") ||
+                directive == QLatin1String("ifndef"))
+                ++preprocessorDepth;
+            else if (directive == QLatin1String("endif"))
+                preprocessorDepth = qMax(0, preprocessorDepth - 1);
+        }
+    }
+
+    // 花括号：跳过字符串与注释
+    const int length = text.length();
+    for (int i = 0; i < length; ++i) {
+        const QChar c = text.at(i);
+        if (inComment) {
+            if (c == '*' && i + 1 < length && text.at(i + 1) == '/') {
+                inComment = false;
+                ++i;
+            }
+            continue;
+        }
+        if (i < isInString.size() && isInString[i]) continue;
+
+        if (c == '/' && i + 1 < length) {
+            if (text.at(i + 1) == '/') break;
+            if (text.at(i + 1) == '*') {
+                inComment = true;
+                ++i;
+                continue;
+            }
+        }
+
+        if (c == '{') {
+            ++braceDepth;
+        } else if (c == '}') {
+            braceDepth = qMax(0, braceDepth - 1);
+            *minBraceDepth = qMin(*minBraceDepth, braceDepth);
+        }
+    }
+
+    return makeState(inComment, preprocessorDepth, braceDepth);
+}
+
+void CppHighlighter::setSemanticTokens(const QVector<SemanticToken> &tokens)
+{
+    QHash<int, QVector<SemanticToken>> byLine;
+    for (const SemanticToken &token : tokens)
+        byLine[token.line].append(token);
+
+    // 找出新旧记号不同的行
+    QSet<int> changedLines;
+    for (auto it = byLine.constBegin(); it != byLine.constEnd(); ++it) {
+        const QVector<SemanticToken> old = semanticTokens.value(it.key());
+        bool same = old.size() == it.value().size();
+        for (int i = 0; same && i < old.size(); ++i) {
+            const SemanticToken &a = old.at(i);
+            const SemanticToken &b = it.value().at(i);
+            same = a.column == b.column && a.length == b.length && a.type == b.type;
+        }
+        if (!same) changedLines.insert(it.key());
     }
+    for (auto it = semanticTokens.constBegin(); it != semanticTokens.constEnd(); ++it) {
+        if (!byLine.contains(it.key())) changedLines.insert(it.key());
+    }
+
+    semanticTokens = byLine;
+
+    if (!document()) return;
+    for (int line : changedLines) {
+        QTextBlock block = document()->findBlockByNumber(line);
+        if (block.isValid())
+            rehighlightBlock(block);
+    }
+}
+
+// ----------------- 缓存状态与后台补齐 -----------------
+void CppHighlighter::setCachedStates(const QVector<int> &states)
+{
+    cachedStates = states;
+    formatPending = !states.isEmpty();
+}
+
+void CppHighlighter::formatInBackground(const QTextBlock &priorityFrom, int priorityCount)
+{
+    if (!document()) return;
+
+    QTextBlock block = priorityFrom;
+    for (int i = 0; i < priorityCount && block.isValid(); ++i, block = block.next())
+        rehighlightBlock(block);
+
+    backgroundCursor = QTextCursor(document());
+    QTimer::singleShot(0, this, &CppHighlighter::formatNextChunk);
+}
+
+void CppHighlighter::formatNextChunk()
+{
+    const int chunkSize = 500;   // 每片的块数，保持单次耗时在一帧以内
+
+    QTextBlock block = backgroundCursor.block();
+    for (int i = 0; i < chunkSize && block.isValid(); ++i, block = block.next())
+        rehighlightBlock(block);
+
+    if (block.isValid()) {
+        backgroundCursor.setPosition(block.position());
+        QTimer::singleShot(0, this, &CppHighlighter::formatNextChunk);
+        return;
+    }
+
+    backgroundCursor = QTextCursor();
+    formatPending = false;
+    emit highlightingFinished();
 }
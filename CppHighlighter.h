@@ -5,6 +5,9 @@
 #include <QTextCharFormat>
 #include <QRegularExpression>
 #include <QVector>
+#include <QHash>
+#include <QTextCursor>
+#include <QTextBlock>
 
 struct HighlightingRule
 {
@@ -12,17 +15,10 @@ struct HighlightingRule
     QTextCharFormat format;
 };
 
-class CppHighlighter : public QSyntaxHighlighter
+// 所有高亮器共用的规则和格式：进程内只构建（并预编译正则）一次，之后只读
+struct HighlightingTheme
 {
-    Q_OBJECT
-public:
-    explicit CppHighlighter(QTextDocument *parent = nullptr);
-
-protected:
-    void highlightBlock(const QString &text) override;
-
-private:
-    QVector<HighlightingRule> highlightingRules;
+    QVector<HighlightingRule> rules;
 
     QTextCharFormat keywordFormat;
     QTextCharFormat typeFormat;
@@ -33,8 +29,76 @@ private:
     QTextCharFormat numberFormat;
     QTextCharFormat preprocessorFormat;
 
+    QRegularExpression stringPattern;
     QRegularExpression commentStartExpression;
     QRegularExpression commentEndExpression;
+
+    QHash<QString, QTextCharFormat> semanticFormats;   // 语义记号类型 -> 格式
+
+    static const HighlightingTheme &shared();
+
+private:
+    HighlightingTheme();
+};
+
+// 语言服务器返回的语义记号（行列从 0 开始）
+struct SemanticToken
+{
+    int line = 0;
+    int column = 0;
+    int length = 0;
+    QString type;   // class / enum / macro / parameter ...
+};
+
+class CppHighlighter : public QSyntaxHighlighter
+{
+    Q_OBJECT
+public:
+    explicit CppHighlighter(QTextDocument *parent = nullptr);
+
+    // 只重新高亮记号发生变化的行
+    void setSemanticTokens(const QVector<SemanticToken> &tokens);
+
+    // 下一次整篇载入文本时直接套用缓存的块状态（按块号对应），不做正则匹配；
+    // 载入完成后发出 cachedStatesApplied，再由 formatInBackground 补齐格式
+    void setCachedStates(const QVector<int> &states);
+    // 先同步高亮 priorityFrom 起的 priorityCount 块（通常是可见区域），其余分片在事件循环中完成
+    void formatInBackground(const QTextBlock &priorityFrom, int priorityCount);
+    bool isFullyHighlighted() const { return !formatPending; }
+
+    // 块状态编码：bit0 = 多行注释未结束，bit1-7 = #if 嵌套深度，bit8 起 = 花括号深度
+    // 状态变化会让 QSyntaxHighlighter 继续处理下一块，嵌套结构因此按块增量维护
+    static bool stateInComment(int state) { return state > 0 && (state & 1); }
+    static int statePreprocessorDepth(int state) { return state > 0 ? (state >> 1) & 0x7f : 0; }
+    static int stateBraceDepth(int state) { return state > 0 ? state >> 8 : 0; }
+    static int makeState(bool inComment, int preprocessorDepth, int braceDepth)
+    {
+        return (inComment ? 1 : 0) | (qBound(0, preprocessorDepth, 0x7f) << 1) | (qMax(0, braceDepth) << 8);
+    }
+
+signals:
+    // 某一块高亮后的颜色摘要发生变化（小地图据此只重绘对应的图块）
+    void blockColorsChanged(int blockNumber);
+
+    void cachedStatesApplied();
+    void highlightingFinished();   // 后台补齐格式完成，块数据（折叠等）已全部可用
+
+protected:
+    void highlightBlock(const QString &text) override;
+
+private:
+    const HighlightingTheme &theme;
+
+    QHash<int, QVector<SemanticToken>> semanticTokens;   // 行号 -> 该行的记号
+
+    QVector<int> cachedStates;
+    bool formatPending = false;
+    QTextCursor backgroundCursor;      // 后台进度，随编辑自动移动
+    void formatNextChunk();
+
+    void updateColorRuns(const QString &text);
+    int computeNesting(const QString &text, const QVector<bool> &isInString,
+                       int previousState, int *minBraceDepth) const;
 };
 
 #endif // CPPHIGHLIGHTER_H
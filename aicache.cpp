@@ -0,0 +1,104 @@
+#include "aicache.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QStringDecoder>
+
+AiCache::AiCache(const QString &directory)
+    : dir(directory)
+{
+}
+
+void AiCache::setCapacity(qint64 bytes)
+{
+    capacity = qMax<qint64>(0, bytes);
+    evict();
+}
+
+QByteArray AiCache::key(const QUrl &endpoint, const QJsonObject &body)
+{
+    // QJsonObject 按键排序，序列化结果与字段插入顺序无关
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    hash.addData(endpoint.toString(QUrl::RemoveUserInfo).toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(QJsonDocument(body).toJson(QJsonDocument::Compact));
+    return hash.result().toHex();
+}
+
+QString AiCache::pathFor(const QByteArray &key) const
+{
+    return dir + "/" + QString::fromLatin1(key) + ".txt";
+}
+
+bool AiCache::lookup(const QByteArray &key, QString *content)
+{
+    // ExistingOnly：未命中时不能留下空文件，否则下次会被当成内容为空的命中
+    QFile file(pathFor(key));
+    if (!file.open(QIODevice::ReadWrite | QIODevice::ExistingOnly)) return false;
+    const QByteArray data = file.readAll();
+
+    // 空文件或不是合法 UTF-8（写到一半、被外部改坏）的条目按未命中处理并删掉
+    QStringDecoder decoder(QStringDecoder::Utf8);
+    const QString text = decoder.decode(data);
+    if (data.isEmpty() || decoder.hasError()) {
+        file.close();
+        if (file.remove() && totalBytes >= 0) totalBytes -= data.size();
+        return false;
+    }
+
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);   // LRU
+    *content = text;
+    return true;
+}
+
+void AiCache::store(const QByteArray &key, const QString &content)
+{
+    const QByteArray data = content.toUtf8();
+    if (capacity <= 0 || data.size() > capacity / 4) return;   // 单条过大不值得占位
+
+    QDir().mkpath(dir);
+    ensureSize();
+    const QString path = pathFor(key);
+    const qint64 previous = QFileInfo(path).size();
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    file.write(data);
+    if (!file.commit()) return;
+
+    totalBytes += data.size() - previous;
+    evict();
+}
+
+void AiCache::clear()
+{
+    QDir(dir).removeRecursively();
+    totalBytes = 0;
+}
+
+void AiCache::ensureSize()
+{
+    if (totalBytes >= 0) return;
+    totalBytes = 0;
+    const QFileInfoList entries = QDir(dir).entryInfoList({"*.txt"}, QDir::Files);
+    for (const QFileInfo &entry : entries)
+        totalBytes += entry.size();
+}
+
+void AiCache::evict()
+{
+    // 启动时不扫描缓存目录；大小在第一次 store() 时才统计
+    if (totalBytes < 0 || totalBytes <= capacity) return;
+
+    // 最久未用的在前；一次删到容量的 80%，避免每次写入都扫描目录
+    const QFileInfoList entries = QDir(dir).entryInfoList({"*.txt"}, QDir::Files, QDir::Time | QDir::Reversed);
+    for (const QFileInfo &entry : entries) {
+        if (totalBytes <= capacity * 4 / 5) break;
+        if (QFile::remove(entry.filePath())) totalBytes -= entry.size();
+    }
+}
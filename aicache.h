@@ -0,0 +1,36 @@
+#ifndef AICACHE_H
+#define AICACHE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+#include <QUrl>
+
+// ----------------------------------------------------------------------
+// AiCache：AI 回复的本地磁盘缓存
+// 以（端点、模型、完整请求体——系统提示词、消息、采样参数）的 SHA-256 为文件名，
+// 内容为完整回复文本。命中时刷新文件修改时间，超出容量时按修改时间淘汰最久未用的条目（LRU）。
+class AiCache
+{
+public:
+    explicit AiCache(const QString &directory);
+
+    void setCapacity(qint64 bytes);   // 目录大小未统计时只记下容量，下次写入再淘汰
+
+    static QByteArray key(const QUrl &endpoint, const QJsonObject &body);
+
+    bool lookup(const QByteArray &key, QString *content);
+    void store(const QByteArray &key, const QString &content);
+    void clear();
+
+private:
+    QString pathFor(const QByteArray &key) const;
+    void ensureSize();           // 首次写入时统计目录大小
+    void evict();
+
+    QString dir;
+    qint64 capacity = 64 * 1024 * 1024;
+    qint64 totalBytes = -1;      // -1 表示尚未统计
+};
+
+#endif // AICACHE_H
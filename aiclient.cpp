@@ -0,0 +1,327 @@
+#include "aiclient.h"
+
+#include <QCoreApplication>
+#include <QJsonDocument>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QRandomGenerator>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTimer>
+#include <memory>
+
+namespace {
+QString settingsFile()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/ai.ini";
+}
+
+// 换一次连接或稍等即可能成功的网络错误
+bool isTransient(QNetworkReply::NetworkError error)
+{
+    switch (error) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::HostNotFoundError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::OperationCanceledError:   // setTransferTimeout 超时
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::ProxyTimeoutError:
+    case QNetworkReply::UnknownNetworkError:
+        return true;
+    default:
+        return false;
+    }
+}
+}
+
+// ----------------- AiSettings -----------------
+bool AiSettings::isLocal() const
+{
+    const QString host = endpoint.host();
+    return host == "localhost" || host == "127.0.0.1" || host == "::1";
+}
+
+AiSettings AiSettings::load()
+{
+    QSettings settings(settingsFile(), QSettings::IniFormat);
+    AiSettings result;
+    result.endpoint = QUrl(settings.value("endpoint", "https://api.deepseek.com/v1/chat/completions").toString());
+    result.apiKey = settings.value("apiKey").toString();
+    result.chatModel = settings.value("chatModel", "deepseek-reasoner").toString();
+    result.codeModel = settings.value("codeModel", "deepseek-chat").toString();
+    result.timeoutMs = qMax(1000, settings.value("timeoutMs", 30000).toInt());
+    result.maxConcurrent = qBound(1, settings.value("maxConcurrent", 2).toInt(), 8);
+    result.maxRetries = qBound(0, settings.value("maxRetries", 2).toInt(), 5);
+    result.contextTokens = qMax(256, settings.value("contextTokens", 3000).toInt());
+    result.historyTokens = qMax(256, settings.value("historyTokens", 4000).toInt());
+    result.cacheEnabled = settings.value("cacheEnabled", true).toBool();
+    result.cacheMegabytes = qBound(1, settings.value("cacheMegabytes", 64).toInt(), 4096);
+    // 行内建议会在每次输入停顿时发送代码，远程端点须由用户自己打开
+    result.inlineCompletion = settings.value("inlineCompletion", result.isLocal()).toBool();
+    return result;
+}
+
+void AiSettings::save() const
+{
+    QSettings settings(settingsFile(), QSettings::IniFormat);
+    settings.setValue("endpoint", endpoint.toString());
+    settings.setValue("apiKey", apiKey);
+    settings.setValue("chatModel", chatModel);
+    settings.setValue("codeModel", codeModel);
+    settings.setValue("timeoutMs", timeoutMs);
+    settings.setValue("maxConcurrent", maxConcurrent);
+    settings.setValue("maxRetries", maxRetries);
+    settings.setValue("contextTokens", contextTokens);
+    settings.setValue("historyTokens", historyTokens);
+    settings.setValue("cacheEnabled", cacheEnabled);
+    settings.setValue("cacheMegabytes", cacheMegabytes);
+    settings.setValue("inlineCompletion", inlineCompletion);
+}
+
+// ----------------- AiReply -----------------
+AiReply::AiReply(const QJsonObject &body, QObject *parent)
+    : QObject(parent)
+    , body(body)
+{
+}
+
+void AiReply::cancel()
+{
+    if (done || cancelled) return;
+    cancelled = true;
+    if (network)
+        network->abort();   // finished 信号里统一收尾
+    else
+        AiClient::instance()->complete(this, false, tr("已取消"));
+}
+
+// ----------------- AiClient -----------------
+AiClient *AiClient::instance()
+{
+    static AiClient *client = new AiClient(QCoreApplication::instance());
+    return client;
+}
+
+AiClient::AiClient(QObject *parent)
+    : QObject(parent)
+    , manager(new QNetworkAccessManager(this))
+    , config(AiSettings::load())
+    , cache(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/ai")
+{
+    cache.setCapacity(qint64(config.cacheMegabytes) * 1024 * 1024);
+}
+
+void AiClient::setSettings(const AiSettings &settings)
+{
+    config = settings;
+    config.save();
+    cache.setCapacity(qint64(config.cacheMegabytes) * 1024 * 1024);
+    schedule();   // 并发上限可能变大
+}
+
+AiReply *AiClient::streamChat(const QString &model, const QJsonArray &messages, const QJsonObject &extra,
+                              RequestKind kind)
+{
+    QJsonObject body = extra;
+    body["model"] = model;
+    body["messages"] = messages;
+    body["stream"] = true;
+
+    AiReply *reply = new AiReply(body, this);
+    if (kind == Inline) {
+        // 新的建议总是取代旧的；延后到事件循环再发出，调用方先连好信号
+        if (inlineReply) inlineReply->cancel();
+        reply->inlineLane = true;
+        inlineReply = reply;
+        QTimer::singleShot(0, reply, [this, reply]() {
+            if (!reply->done) start(reply);
+        });
+        return reply;
+    }
+
+    if (config.cacheEnabled) {
+        reply->cacheKey = AiCache::key(config.endpoint, body);
+        QString content;
+        if (cache.lookup(reply->cacheKey, &content)) {
+            // 重放同样计入忙碌状态，“停止生成”对命中和未命中一视同仁
+            replaying.append(reply);
+            updateBusy();
+            replay(reply, content);
+            return reply;
+        }
+    }
+    queue.enqueue(reply);
+    updateBusy();
+
+    // 延后到事件循环再发出，调用方先连好信号
+    QMetaObject::invokeMethod(this, &AiClient::schedule, Qt::QueuedConnection);
+    return reply;
+}
+
+void AiClient::cancelAll()
+{
+    const QList<AiReply *> running = active;
+    for (AiReply *reply : running)
+        reply->cancel();
+    const QQueue<QPointer<AiReply>> waiting = queue;
+    for (const QPointer<AiReply> &reply : waiting) {
+        if (reply) reply->cancel();
+    }
+    const QList<AiReply *> replays = replaying;
+    for (AiReply *reply : replays)
+        reply->cancel();
+}
+
+void AiClient::schedule()
+{
+    while (active.size() < config.maxConcurrent && !queue.isEmpty()) {
+        AiReply *reply = queue.dequeue();
+        if (!reply || reply->done) continue;
+        active.append(reply);
+        start(reply);
+    }
+    updateBusy();
+}
+
+void AiClient::replay(AiReply *reply, const QString &content)
+{
+    reply->fromCache = true;
+    reply->cacheKey.clear();
+
+    // 分成约 20 段、每帧一段，界面按正常的流式路径更新；首段在调用方连好信号之后才发出
+    const int chunk = qMax(32, int(content.size() / 20) + 1);
+    QTimer *timer = new QTimer(reply);
+    timer->setInterval(16);
+    auto offset = std::make_shared<int>(0);
+    connect(timer, &QTimer::timeout, reply, [=]() {
+        if (reply->done) return;
+        if (*offset >= content.size()) {
+            timer->stop();
+            complete(reply, true, QString());
+            return;
+        }
+        reply->streamed = true;
+        emit reply->delta(content.mid(*offset, chunk));
+        *offset += chunk;
+    });
+    timer->start();
+}
+
+void AiClient::start(AiReply *reply)
+{
+    ++reply->attempts;
+
+    QNetworkRequest request(config.endpoint);
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/json");
+    request.setRawHeader("Accept", "text/event-stream");
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    request.setTransferTimeout(config.timeoutMs);
+
+    // 配置里没有 Key 时退回环境变量；本机端点可以不带 Key
+    const QString apiKey = config.apiKey.isEmpty() ? qEnvironmentVariable("CIDE_AI_API_KEY") : config.apiKey;
+    if (!apiKey.isEmpty()) {
+        request.setRawHeader("Authorization", "Bearer " + apiKey.toUtf8());
+    } else if (!config.isLocal()) {
+        complete(reply, false, tr("未配置 API Key，请在 Set → AI Settings 中填写"));
+        return;
+    }
+
+    reply->parser.reset();
+    QNetworkReply *network = manager->post(request, QJsonDocument(reply->body).toJson(QJsonDocument::Compact));
+    reply->network = network;
+    connect(network, &QNetworkReply::readyRead, reply, [this, reply]() {
+        // 错误响应的正文不是事件流，留到 finished 时整体读取
+        if (reply->network->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() >= 400) return;
+        reply->parser.readFrom(reply->network);
+        dispatch(reply, false);
+    });
+    connect(network, &QNetworkReply::finished, reply, [this, reply]() { onFinished(reply); });
+}
+
+void AiClient::dispatch(AiReply *reply, bool atEnd)
+{
+    SseEvent event;
+    while (atEnd ? reply->parser.finish(event) : reply->parser.next(event)) {
+        if (event.isDone()) continue;
+        const QString content = SseParser::chatDelta(event.data);
+        if (content.isEmpty()) continue;
+        reply->streamed = true;
+        if (!reply->cacheKey.isEmpty()) reply->content += content;
+        emit reply->delta(content);
+        if (reply->done || reply->cancelled) return;   // 接收方在 delta 中停止了生成
+    }
+}
+
+void AiClient::onFinished(AiReply *reply)
+{
+    QNetworkReply *network = reply->network;
+    reply->network = nullptr;
+    network->deleteLater();
+    if (reply->done) return;
+    if (reply->cancelled) {
+        complete(reply, false, tr("已取消"));
+        return;
+    }
+
+    const int status = network->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    const QNetworkReply::NetworkError error = network->error();
+    if (error == QNetworkReply::NoError && status < 400) {
+        reply->parser.readFrom(network);
+        dispatch(reply, true);
+        if (!reply->cacheKey.isEmpty() && !reply->content.isEmpty())
+            cache.store(reply->cacheKey, reply->content);
+        complete(reply, true, QString());
+        return;
+    }
+
+    QString message = network->errorString();
+    if (status >= 400) {
+        const QJsonObject obj = QJsonDocument::fromJson(network->readAll()).object();
+        const QString detail = obj.value("error").toObject().value("message").toString();
+        message = detail.isEmpty() ? QString("HTTP %1").arg(status) : QString("HTTP %1: %2").arg(status).arg(detail);
+    } else if (error == QNetworkReply::OperationCanceledError) {
+        message = tr("%1 秒内没有收到数据，请求超时").arg(config.timeoutMs / 1000);
+    }
+
+    // 已经输出了一部分内容时重试会得到重复文本，只报告错误
+    // 行内建议过时得很快，失败了等下一次输入停顿即可
+    const bool retryable = status == 429 || status >= 500 || (status == 0 && isTransient(error));
+    if (retryable && !reply->inlineLane && !reply->streamed && reply->attempts <= config.maxRetries) {
+        int delay = 500 << (reply->attempts - 1);
+        bool ok = false;
+        const int retryAfter = network->rawHeader("Retry-After").toInt(&ok);
+        if (ok) delay = qMax(delay, qMin(retryAfter, 60) * 1000);
+        delay += QRandomGenerator::global()->bounded(delay / 4 + 1);   // 抖动，避免多个请求同时重试
+        QTimer::singleShot(delay, reply, [this, reply]() {
+            if (!reply->done) start(reply);
+        });
+        return;
+    }
+    complete(reply, false, message);
+}
+
+void AiClient::complete(AiReply *reply, bool ok, const QString &errorString)
+{
+    if (reply->done) return;
+    reply->done = true;
+    active.removeOne(reply);
+    queue.removeAll(reply);
+    replaying.removeOne(reply);
+
+    emit reply->finished(ok, errorString);
+    reply->deleteLater();
+
+    updateBusy();
+    QMetaObject::invokeMethod(this, &AiClient::schedule, Qt::QueuedConnection);
+}
+
+void AiClient::updateBusy()
+{
+    const bool now = !active.isEmpty() || !queue.isEmpty() || !replaying.isEmpty();
+    if (now == busy) return;
+    busy = now;
+    emit busyChanged(busy);
+}
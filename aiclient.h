@@ -0,0 +1,129 @@
+#ifndef AICLIENT_H
+#define AICLIENT_H
+
+#include <QObject>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QList>
+#include <QPointer>
+#include <QQueue>
+#include <QUrl>
+
+#include "aicache.h"
+#include "sseparser.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// AI 服务配置，保存在 AppConfigLocation/ai.ini
+// 端点可以指向任意 OpenAI 兼容的 chat/completions 接口（如本机的 llama.cpp server），
+// 此时 API Key 可以留空。
+struct AiSettings
+{
+    QUrl endpoint;
+    QString apiKey;
+    QString chatModel;           // 对话面板
+    QString codeModel;           // 改代码等编辑器内功能
+    int timeoutMs = 30000;       // 连续这么久收不到任何数据即视为超时
+    int maxConcurrent = 2;       // 同时进行的请求数
+    int maxRetries = 2;          // 连接失败、429、5xx 时的重试次数
+    int contextTokens = 3000;    // 改代码时附带的代码上下文 token 上限
+    int historyTokens = 4000;    // 对话历史随请求发送的 token 上限
+    bool cacheEnabled = true;    // 相同请求直接重放本地缓存的回复
+    int cacheMegabytes = 64;
+    bool inlineCompletion = false;  // 编辑器中的 AI 行内建议；未设置过时只对本机端点默认开启
+
+    bool isLocal() const;        // 指向本机，无需 Key
+    static AiSettings load();
+    void save() const;
+};
+
+// ----------------------------------------------------------------------
+// AiReply：一次流式补全请求的句柄
+// 由 AiClient 创建并持有，finished 之后自动 deleteLater。
+class AiReply : public QObject
+{
+    Q_OBJECT
+public:
+    void cancel();               // 停止生成；排队中的请求直接出队
+    bool isFinished() const { return done; }
+    bool isCancelled() const { return cancelled; }
+    bool isFromCache() const { return fromCache; }
+
+signals:
+    void delta(const QString &content);
+    void finished(bool ok, const QString &errorString);   // 每个请求恰好一次
+
+private:
+    friend class AiClient;
+    explicit AiReply(const QJsonObject &body, QObject *parent);
+
+    QJsonObject body;
+    QPointer<QNetworkReply> network;
+    SseParser parser;
+    int attempts = 0;
+    bool streamed = false;       // 已经输出过内容，中途失败不能再重试
+    QByteArray cacheKey;         // 为空表示不写缓存
+    bool inlineLane = false;     // 行内建议通道的请求
+    QString content;             // 完整回复，成功后写入缓存
+    bool fromCache = false;
+    bool cancelled = false;
+    bool done = false;
+};
+
+// ----------------------------------------------------------------------
+// AiClient：进程内唯一的 AI 请求入口
+// 所有请求共用一个 QNetworkAccessManager，同一主机的 HTTP/2 连接得以复用；
+// 超出并发上限的请求排队。每个请求有无数据超时，连接错误、429 和 5xx
+// 在尚未输出内容时按指数退避重试（优先遵循 Retry-After）。
+// 行内建议走单独的通道：不排队、不占对话的并发名额、不计入忙碌状态，
+// “停止生成”也不影响它；同一时刻只保留最新的一个。
+class AiClient : public QObject
+{
+    Q_OBJECT
+public:
+    enum RequestKind {
+        Interactive,             // 对话、改代码：排队，计入忙碌状态，结果写入缓存
+        Inline                   // 行内建议：独立通道，不查也不写缓存，失败不重试
+    };
+
+    static AiClient *instance();
+
+    const AiSettings &settings() const { return config; }
+    void setSettings(const AiSettings &settings);   // 保存并对之后的请求生效
+
+    // 流式对话补全；extra 中的字段（temperature、max_tokens 等）合并进请求体
+    // 命中缓存时不发请求，按帧分段重放缓存的回复
+    AiReply *streamChat(const QString &model, const QJsonArray &messages,
+                        const QJsonObject &extra = QJsonObject(), RequestKind kind = Interactive);
+    void clearCache() { cache.clear(); }
+
+    void cancelAll();            // 停止所有进行中、排队和正在重放缓存的请求
+    bool isBusy() const { return busy; }
+
+signals:
+    void busyChanged(bool busy);
+
+private:
+    friend class AiReply;
+    explicit AiClient(QObject *parent = nullptr);
+
+    void schedule();
+    void replay(AiReply *reply, const QString &content);
+    void start(AiReply *reply);
+    void dispatch(AiReply *reply, bool atEnd);   // 把解析出的事件作为 delta 发出
+    void onFinished(AiReply *reply);
+    void complete(AiReply *reply, bool ok, const QString &errorString);
+    void updateBusy();
+
+    QNetworkAccessManager *manager = nullptr;
+    AiSettings config;
+    AiCache cache;
+    QQueue<QPointer<AiReply>> queue;
+    QList<AiReply *> active;     // 已占用并发名额（含等待重试）的请求
+    QPointer<AiReply> inlineReply;   // 行内建议通道上的请求
+    QList<AiReply *> replaying;  // 正在重放缓存的请求（不占并发名额）
+    bool busy = false;
+};
+
+#endif // AICLIENT_H
@@ -0,0 +1,51 @@
+#ifndef BLOCKDATA_H
+#define BLOCKDATA_H
+
+#include <QTextBlockUserData>
+#include <QStringList>
+#include <QVector>
+#include <QColor>
+#include "completionindex.h"
+
+// ----------------------------------------------------------------------
+// BlockData：高亮器按块维护的附加数据
+// 块被删除时 Qt 会析构它，借此把该行的标识符从补全索引中撤回。
+class BlockData : public QTextBlockUserData
+{
+public:
+    enum FoldKind { NoFold, BraceFold, CommentFold, PreprocessorFold };
+
+    // 行号区标记（位掩码），随块移动，行号变化时无需重新映射
+    enum Marker { BreakpointMarker = 0x1, ExecutionMarker = 0x2 };
+
+    // 同色连续字符（按可视列计，Tab 展开为 4 列），供小地图绘制
+    struct ColorRun
+    {
+        int start;
+        int length;
+        QRgb color;
+        bool operator==(const ColorRun &other) const
+        {
+            return start == other.start && length == other.length && color == other.color;
+        }
+    };
+
+    ~BlockData() override
+    {
+        if (!identifiers.isEmpty())
+            CompletionIndex::instance()->removeWords(identifiers);
+    }
+
+    QStringList identifiers;   // 本行出现的标识符（已计入补全索引）
+
+    // 折叠信息（由高亮器增量计算）
+    FoldKind foldKind = NoFold;
+    int minBraceDepth = 0;     // 本行扫描过程中花括号深度的最小值
+    bool folded = false;       // 以本行为起点的区域当前是否折叠
+
+    QVector<ColorRun> colorRuns;   // 高亮完成后的颜色摘要
+
+    int markers = 0;           // Marker 位掩码
+};
+
+#endif // BLOCKDATA_H
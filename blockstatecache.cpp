@@ -0,0 +1,76 @@
+#include "blockstatecache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QStandardPaths>
+
+namespace {
+const quint32 kMagic = 0x43424c53;   // "CBLS"
+const quint32 kVersion = 1;          // 块状态编码（CppHighlighter::makeState）变化时递增
+const int kMaxEntries = 200;
+}
+
+QString BlockStateCache::cacheDir()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + "/blockstates";
+}
+
+QString BlockStateCache::fileFor(const QString &text)
+{
+    // 直接对 UTF-16 原始字节求哈希，省去一次编码转换
+    const QByteArray bytes = QByteArray::fromRawData(reinterpret_cast<const char*>(text.constData()),
+                                                     text.size() * qsizetype(sizeof(QChar)));
+    return cacheDir() + '/' + QString::fromLatin1(QCryptographicHash::hash(bytes, QCryptographicHash::Sha1).toHex());
+}
+
+QVector<int> BlockStateCache::load(const QString &text)
+{
+    if (text.isEmpty()) return {};
+
+    QFile file(fileFor(text));
+    if (!file.open(QIODevice::ReadOnly)) return {};
+
+    QDataStream in(qUncompress(file.readAll()));
+    quint32 magic = 0;
+    quint32 version = 0;
+    QVector<int> states;
+    in >> magic >> version;
+    if (magic != kMagic || version != kVersion) return {};
+    in >> states;
+    if (in.status() != QDataStream::Ok) return {};
+    file.close();
+
+    // 更新访问时间，供淘汰时判断
+    file.open(QIODevice::ReadWrite);
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return states;
+}
+
+void BlockStateCache::store(const QString &text, const QVector<int> &states)
+{
+    if (text.isEmpty() || states.isEmpty()) return;
+    if (!QDir().mkpath(cacheDir())) return;
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out << kMagic << kVersion << states;
+
+    QFile file(fileFor(text));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return;
+    file.write(qCompress(data));
+    file.close();
+
+    prune();
+}
+
+void BlockStateCache::prune()
+{
+    QDir dir(cacheDir());
+    const QFileInfoList entries = dir.entryInfoList(QDir::Files, QDir::Time);   // 最新的在前
+    for (int i = kMaxEntries; i < entries.size(); ++i)
+        QFile::remove(entries.at(i).absoluteFilePath());
+}
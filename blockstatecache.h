@@ -0,0 +1,23 @@
+#ifndef BLOCKSTATECACHE_H
+#define BLOCKSTATECACHE_H
+
+#include <QString>
+#include <QVector>
+
+// ----------------------------------------------------------------------
+// BlockStateCache：按文件内容哈希缓存高亮器的块状态
+// 再次打开内容未变的文件时直接套用缓存状态，首帧前不必对整篇文本做正则匹配。
+// 缓存放在系统缓存目录下，每个内容一个小文件，超出数量上限时删除最久未用的。
+class BlockStateCache
+{
+public:
+    static QVector<int> load(const QString &text);
+    static void store(const QString &text, const QVector<int> &states);
+
+private:
+    static QString cacheDir();
+    static QString fileFor(const QString &text);
+    static void prune();
+};
+
+#endif // BLOCKSTATECACHE_H
@@ -2,36 +2,33 @@
 #include <QPainter>
 #include <QTextBlock>
 #include "CppHighlighter.h"
+#include "completionindex.h"
+#include "blockdata.h"
+#include "minimap.h"
+#include "gutterrenderer.h"
+#include "fontservice.h"
 #include <QStack>
 #include <QPair>
 #include <QTimer>
+#include <QCompleter>
+#include <QStringListModel>
+#include <QAbstractItemView>
+#include <QScrollBar>
+#include <QToolTip>
+#include <QHelpEvent>
+#include <QMouseEvent>
+#include <QSet>
+#include <QtMath>
+#include <algorithm>
+#include <functional>
 
-#include <QFontDatabase>
 
 CodeEditor::CodeEditor(QWidget *parent) : QPlainTextEdit(parent)
 {
     lineNumberArea = new LineNumberArea(this);
 
-    // ===== 注册 JetBrains Mono 字体 =====
-    int id = QFontDatabase::addApplicationFont(":/new/prefix2/fonts/JetBrainsMonoNL-Bold.ttf");
-    if (id != -1) {
-        QString family = QFontDatabase::applicationFontFamilies(id).at(0);
-
-        QFont font(family);
-        font.setPointSize(14);           // 可根据喜好调整
-        font.setStyleHint(QFont::Monospace);
-        font.setFixedPitch(true);        // JetBrains Mono 是等宽字体
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-        font.setStyleStrategy(QFont::PreferAntialias);
-        font.setKerning(true);
-#endif
-        setFont(font);
-        qDebug() << "Loaded font:" << family;
-
-    } else {
-        qDebug() << "Failed to load JetBrains Mono font, fallback to system default";
-    }
-
+    // ===== 字体：进程内只注册一次，所有编辑器共用 =====
+    setFont(FontService::instance()->editorFont());
 
     // ===== 信号槽绑定 =====
     connect(this, &QPlainTextEdit::blockCountChanged, this, &CodeEditor::updateLineNumberAreaWidth);
@@ -39,10 +36,61 @@ CodeEditor::CodeEditor(QWidget *parent) : QPlainTextEdit(parent)
     connect(this, &QPlainTextEdit::cursorPositionChanged, this, &CodeEditor::highlightCurrentLine);
 
 
+    gutter.setFont(font(), devicePixelRatioF());
     updateLineNumberAreaWidth(0);
     highlightCurrentLine();
 
-    new CppHighlighter(this->document());
+    highlighter = new CppHighlighter(this->document());
+
+    connect(highlighter, &CppHighlighter::cachedStatesApplied, this, &CodeEditor::formatAfterCachedLoad);
+
+    // ===== 小地图 =====
+    minimap = new Minimap(this);
+    connectDocument();
+    connect(verticalScrollBar(), &QScrollBar::valueChanged, minimap, QOverload<>::of(&QWidget::update));
+    connect(this, &QPlainTextEdit::cursorPositionChanged, this, &CodeEditor::revealCursorBlock);
+    connect(this, &QPlainTextEdit::cursorPositionChanged, this, [this]() {
+        // 行内建议只在原位置有效（继续输入时 onGhostContentsChange 已先把位置后移）
+        if (!ghost.isEmpty() && (textCursor().position() != ghostPosition || textCursor().hasSelection()))
+            clearGhostText();
+    });
+
+    // ===== 补全弹窗 =====
+    completer = new QCompleter(this);
+    completer->setModel(new QStringListModel(completer));
+    completer->setWidget(this);
+    completer->setCompletionMode(QCompleter::PopupCompletion);
+    completer->setCaseSensitivity(Qt::CaseInsensitive);
+    connect(completer, QOverload<const QString &>::of(&QCompleter::activated),
+            this, &CodeEditor::insertCompletion);
+}
+
+void CodeEditor::connectDocument()
+{
+    // 高亮器先于此处连接 contentsChange，回调时块数据已是最新
+    connect(document(), &QTextDocument::contentsChange, this, &CodeEditor::checkFoldsAfterEdit);
+    connect(highlighter, &CppHighlighter::blockColorsChanged, minimap, &Minimap::markBlockDirty);
+    connect(document(), &QTextDocument::contentsChange, minimap, &Minimap::onContentsChange);
+    connect(document(), &QTextDocument::contentsChange, this, &CodeEditor::onGhostContentsChange);
+}
+
+void CodeEditor::shareDocumentWith(CodeEditor *source)
+{
+    if (!source || source == this || source->document() == document()) return;
+
+    // 原有文档是本编辑器的子对象，setDocument 会连同其上的高亮器一起删除
+    highlighter = source->highlighter;
+    setDocument(source->document());
+    connectDocument();
+
+    // 共享的 QPlainTextDocumentLayout 只有一个换行宽度，各视图宽度不同时不能按视图折行
+    setLineWrapMode(QPlainTextEdit::NoWrap);
+    source->setLineWrapMode(QPlainTextEdit::NoWrap);
+
+    setFont(source->font());
+    updateLineNumberAreaWidth(0);
+    minimap->onContentsChange(0, 0, document()->characterCount());
+    highlightCurrentLine();
 }
 
 void CodeEditor::wheelEvent(QWheelEvent *event)
@@ -79,24 +127,49 @@ int CodeEditor::lineNumberAreaWidth() const
     int digits = 1;
     int max = qMax(1, blockCount());
     while (max >= 10) { max /= 10; ++digits; }
-    int space = 3 + fontMetrics().horizontalAdvance(QLatin1Char('9')) * digits;
-    return space;
+    return gutter.widthFor(digits);
+}
+
+int CodeEditor::foldMarkerWidth() const
+{
+    return gutter.foldWidth();
+}
+
+void CodeEditor::changeEvent(QEvent *event)
+{
+    QPlainTextEdit::changeEvent(event);
+    if (event->type() == QEvent::FontChange) {
+        gutter.setFont(font(), devicePixelRatioF());
+        updateLineNumberAreaWidth(0);
+        lineNumberArea->update();
+    }
 }
 
 void CodeEditor::updateLineNumberAreaWidth(int)
 {
-    setViewportMargins(lineNumberAreaWidth(), 0, 0, 0);
+    const int width = lineNumberAreaWidth();
+    setViewportMargins(width, 0, Minimap::preferredWidth(), 0);
+
+    // 位数变化时行号区跟着变宽，不必等到下一次 resizeEvent
+    if (lineNumberArea->width() != width) {
+        const QRect cr = contentsRect();
+        lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), width, cr.height()));
+    }
 }
 
 void CodeEditor::updateLineNumberArea(const QRect &rect, int dy)
 {
-    if (dy)
+    if (dy) {
         lineNumberArea->scroll(0, dy);
-    else
-        lineNumberArea->update(0, rect.y(), lineNumberArea->width(), rect.height());
+        return;
+    }
 
-    if (dy == 0)
-        lineNumberArea->update();
+    // 只重绘变化的行。编辑会影响上一行的折叠标记（可折叠与否取决于下一行），多刷新一行
+    const int lineHeight = gutter.lineHeight();
+    lineNumberArea->update(0, rect.y() - lineHeight, lineNumberArea->width(), rect.height() + lineHeight);
+
+    if (rect.contains(viewport()->rect()))
+        updateLineNumberAreaWidth(0);
 }
 
 void CodeEditor::resizeEvent(QResizeEvent *event)
@@ -104,6 +177,11 @@ void CodeEditor::resizeEvent(QResizeEvent *event)
     QPlainTextEdit::resizeEvent(event);
     QRect cr = contentsRect();
     lineNumberArea->setGeometry(QRect(cr.left(), cr.top(), lineNumberAreaWidth(), cr.height()));
+
+    // 小地图紧贴视口右侧（滚动条左边）
+    if (!minimap) return;
+    const QRect vr = viewport()->geometry();
+    minimap->setGeometry(QRect(vr.right() + 1, vr.top(), Minimap::preferredWidth(), vr.height()));
 }
 
 // ---------------- 行高亮 + 括号匹配高亮 ----------------
@@ -122,9 +200,21 @@ void CodeEditor::highlightCurrentLine()
         extraSelections.append(lineSel);
     }
 
+    // 调试器当前行（压在光标行之上）
+    if (!executionLine.isNull()) {
+        QTextEdit::ExtraSelection execSel;
+        execSel.format.setBackground(QColor(255, 236, 140));
+        execSel.format.setProperty(QTextFormat::FullWidthSelection, true);
+        execSel.cursor = executionLine;
+        extraSelections.append(execSel);
+    }
+
     QString text = document()->toPlainText();
     int pos = textCursor().position();
-    if (text.isEmpty() || pos < 0 || pos >= text.size()) return;
+    if (text.isEmpty() || pos < 0 || pos >= text.size()) {
+        applyExtraSelections(extraSelections);
+        return;
+    }
 
     // 只检查光标直接所在的字符是否是括号
     QChar charAtPos = text.at(pos);
@@ -134,14 +224,14 @@ void CodeEditor::highlightCurrentLine()
 
     // 如果不是括号，直接返回
     if (!isBracket) {
-        setExtraSelections(extraSelections);
+        applyExtraSelections(extraSelections);
         return;
     }
 
     // 查找匹配的括号
     int matchPos = findMatchingBracket(text, pos);
     if (matchPos == -1) {
-        setExtraSelections(extraSelections);
+        applyExtraSelections(extraSelections);
         return;
     }
 
@@ -160,7 +250,185 @@ void CodeEditor::highlightCurrentLine()
     extraSelections.append(makeSelection(pos));
     extraSelections.append(makeSelection(matchPos));
 
-    setExtraSelections(extraSelections);
+    applyExtraSelections(extraSelections);
+}
+
+void CodeEditor::applyExtraSelections(QList<QTextEdit::ExtraSelection> selections)
+{
+    // 待审阅的修改与诊断波浪线叠加在行高亮和括号高亮之上
+    selections.append(reviewSelections);
+    selections.append(diagnosticSelections);
+
+    // 附加光标的选区
+    for (const QTextCursor &cursor : std::as_const(secondaryCursors)) {
+        if (!cursor.hasSelection()) continue;
+        QTextEdit::ExtraSelection sel;
+        sel.cursor = cursor;
+        sel.format.setBackground(palette().highlight());
+        sel.format.setForeground(palette().highlightedText());
+        selections.append(sel);
+    }
+    setExtraSelections(selections);
+}
+
+// ---------------- 诊断 ----------------
+
+bool CodeEditor::diagnosticRange(const Diagnostic &diagnostic, int *start, int *end) const
+{
+    QTextBlock startBlock = document()->findBlockByNumber(diagnostic.line);
+    if (!startBlock.isValid()) return false;
+    QTextBlock endBlock = document()->findBlockByNumber(diagnostic.endLine);
+    if (!endBlock.isValid()) endBlock = startBlock;
+
+    *start = startBlock.position() + qBound(0, diagnostic.column, startBlock.length() - 1);
+    *end = endBlock.position() + qBound(0, diagnostic.endColumn, endBlock.length() - 1);
+
+    // 零宽诊断至少标出一个字符
+    if (*end <= *start) {
+        const int blockEnd = startBlock.position() + startBlock.length() - 1;
+        *end = qMin(*start + 1, blockEnd);
+        if (*end <= *start) *start = qMax(startBlock.position(), *start - 1);
+    }
+    return true;
+}
+
+void CodeEditor::setDiagnostics(const QList<Diagnostic> &list)
+{
+    diagnostics = list;
+    diagnosticSelections.clear();
+    diagnosticLines.clear();
+
+    for (const Diagnostic &diagnostic : diagnostics) {
+        int start = 0;
+        int end = 0;
+        if (!diagnosticRange(diagnostic, &start, &end)) continue;
+
+        // 级别数值越小越严重
+        const int previous = diagnosticLines.value(diagnostic.line, 0);
+        if (previous == 0 || diagnostic.severity < previous)
+            diagnosticLines.insert(diagnostic.line, diagnostic.severity);
+
+        QTextEdit::ExtraSelection sel;
+        sel.cursor = QTextCursor(document());
+        sel.cursor.setPosition(start);
+        sel.cursor.setPosition(end, QTextCursor::KeepAnchor);
+        sel.format.setUnderlineStyle(QTextCharFormat::WaveUnderline);
+        if (diagnostic.severity == Diagnostic::Error)
+            sel.format.setUnderlineColor(Qt::red);
+        else if (diagnostic.severity == Diagnostic::Warning)
+            sel.format.setUnderlineColor(QColor(255, 140, 0));
+        else
+            sel.format.setUnderlineColor(Qt::blue);
+        diagnosticSelections.append(sel);
+    }
+
+    highlightCurrentLine();
+    lineNumberArea->update();
+    if (minimap) minimap->update();
+}
+
+void CodeEditor::setSearchHits(const QList<QTextCursor> &hits)
+{
+    minimap->setSearchHits(hits);
+}
+
+void CodeEditor::setReviewSelections(const QList<QTextEdit::ExtraSelection> &selections)
+{
+    reviewSelections = selections;
+    highlightCurrentLine();
+}
+
+bool CodeEditor::viewportEvent(QEvent *event)
+{
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent *helpEvent = static_cast<QHelpEvent*>(event);
+        const int pos = cursorForPosition(helpEvent->pos()).position();
+
+        // 先看是否落在诊断范围内，否则交给语言服务器
+        for (const Diagnostic &diagnostic : diagnostics) {
+            int start = 0;
+            int end = 0;
+            if (diagnosticRange(diagnostic, &start, &end) && pos >= start && pos <= end) {
+                QToolTip::showText(helpEvent->globalPos(), diagnostic.message, this);
+                return true;
+            }
+        }
+
+        QToolTip::hideText();
+        emit hoverRequested(pos, helpEvent->globalPos());
+        return true;
+    }
+    return QPlainTextEdit::viewportEvent(event);
+}
+
+// ---------------- 补全 ----------------
+
+QString CodeEditor::wordBeforeCursor() const
+{
+    const QTextCursor cursor = textCursor();
+    const QString text = cursor.block().text();
+    int start = cursor.positionInBlock();
+    while (start > 0 && (text.at(start - 1).isLetterOrNumber() || text.at(start - 1) == '_'))
+        --start;
+    return text.mid(start, cursor.positionInBlock() - start);
+}
+
+void CodeEditor::showCompletions(int position, const QStringList &items)
+{
+    // 回复到达前光标已离开当前单词，结果作废
+    if (qAbs(textCursor().position() - position) > wordBeforeCursor().length())
+        return;
+
+    lspCompletions = items;
+    refreshCompletions(true);
+}
+
+void CodeEditor::refreshCompletions(bool force)
+{
+    const QString prefix = wordBeforeCursor();
+    if (prefix.isEmpty() && !force) {
+        completer->popup()->hide();
+        return;
+    }
+    if (prefix.length() < 2 && !force && !completer->popup()->isVisible())
+        return;
+
+    // 语言服务器结果在前，本地前缀树（缓冲区 + 项目标识符）按词频补充
+    QStringList items;
+    for (const QString &item : lspCompletions) {
+        if (item.startsWith(prefix, Qt::CaseInsensitive) && !items.contains(item))
+            items.append(item);
+    }
+    const QStringList local = CompletionIndex::instance()->complete(prefix, 50);
+    for (const QString &word : local) {
+        if (word != prefix && !items.contains(word))
+            items.append(word);
+    }
+
+    if (items.isEmpty()) {
+        completer->popup()->hide();
+        return;
+    }
+
+    static_cast<QStringListModel*>(completer->model())->setStringList(items);
+    completer->setCompletionPrefix(prefix);
+    completer->popup()->setCurrentIndex(completer->completionModel()->index(0, 0));
+
+    if (!completer->popup()->isVisible()) {
+        QRect rect = cursorRect();
+        rect.setWidth(completer->popup()->sizeHintForColumn(0)
+                      + completer->popup()->verticalScrollBar()->sizeHint().width());
+        completer->complete(rect);
+    }
+}
+
+void CodeEditor::insertCompletion(const QString &completion)
+{
+    // 用候选整体替换光标前的单词
+    QTextCursor cursor = textCursor();
+    cursor.movePosition(QTextCursor::Left, QTextCursor::KeepAnchor, wordBeforeCursor().length());
+    cursor.insertText(completion);
+    setTextCursor(cursor);
 }
 
 int CodeEditor::findMatchingBracket(const QString& text, int pos)
@@ -260,99 +528,450 @@ int CodeEditor::findMatchingBracket(const QString& text, int pos)
 
 void CodeEditor::lineNumberAreaPaintEvent(QPaintEvent *event)
 {
+    gutter.setFont(font(), lineNumberArea->devicePixelRatioF());
+
     QPainter painter(lineNumberArea);
-    painter.fillRect(event->rect(), Qt::lightGray);
-
-    QTextBlock block = firstVisibleBlock();
-    int blockNumber = block.blockNumber();
-    int topMargin = contentOffset().y();
-    int top = (int)blockBoundingGeometry(block).translated(0, topMargin).top();
-    int bottom = top + (int)blockBoundingRect(block).height();
-
-    while (block.isValid() && top <= event->rect().bottom()) {
-        if (block.isVisible() && bottom >= event->rect().top()) {
-            QString number = QString::number(blockNumber + 1);
-            painter.setPen(Qt::black);
-            painter.drawText(0, top, lineNumberArea->width() - 2, fontMetrics().height(),
-                             Qt::AlignRight | Qt::AlignVCenter, number);
+    const QRect dirty = event->rect();
+    painter.fillRect(dirty, Qt::lightGray);
+
+    // 直接从脏区域顶部所在的块开始绘制，不必从第一个可见块逐行走过来
+    QTextBlock block = cursorForPosition(QPoint(0, dirty.top())).block();
+    int top = qRound(blockBoundingGeometry(block).translated(contentOffset()).top());
+    const int width = lineNumberArea->width();
+
+    while (block.isValid() && top <= dirty.bottom()) {
+        const int height = qRound(blockBoundingRect(block).height());
+        if (block.isVisible() && top + height >= dirty.top()) {
+            GutterRenderer::Row row;
+            row.lineNumber = block.blockNumber() + 1;
+            row.markers = lineMarkers(block);
+            row.diagnosticSeverity = diagnosticLines.value(block.blockNumber(), 0);
+            if (isFolded(block))
+                row.fold = GutterRenderer::Collapsed;
+            else if (isFoldable(block))
+                row.fold = GutterRenderer::Expanded;
+            gutter.paintRow(painter, QRect(0, top, width, height), row);
         }
 
+        top += height;
         block = block.next();
-        top = bottom;
-        bottom = top + (int)blockBoundingRect(block).height();
-        ++blockNumber;
     }
 }
 
-// ---------------- 自动补全括号 ----------------
-void CodeEditor::keyPressEvent(QKeyEvent *event)
+// ---------------- 行号区标记 ----------------
+
+void CodeEditor::setLineMarker(const QTextBlock &block, int marker, bool on)
 {
-    QTextCursor cursor = textCursor();
-    QChar ch = event->text().isEmpty() ? QChar() : event->text().at(0);
+    if (!block.isValid()) return;
+
+    QTextBlock target = block;
+    BlockData *data = static_cast<BlockData*>(target.userData());
+    if (!data) {
+        // 高亮器尚未处理到该块时先建好，高亮器会沿用已有的块数据
+        data = new BlockData;
+        target.setUserData(data);
+    }
 
-    // 缩进单位（你可以改成 "\t" 或更短/更长的空格）
-    const QString indentUnit = "\t";  // 一个制表符
+    const int markers = on ? (data->markers | marker) : (data->markers & ~marker);
+    if (markers == data->markers) return;
+    data->markers = markers;
+    updateGutterRow(block);
+}
 
+int CodeEditor::lineMarkers(const QTextBlock &block) const
+{
+    const BlockData *data = static_cast<const BlockData*>(block.userData());
+    return data ? data->markers : 0;
+}
 
-    // ---------- Enter: 处理光标在配对括号中间的智能换行 ----------
-    if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) {
-        int pos = cursor.position();
-        QChar leftChar = (pos > 0) ? document()->characterAt(pos - 1) : QChar();
-        QChar rightChar = document()->characterAt(pos);
-
-        QMap<QChar, QChar> pairs = {
-            {'(', ')'},
-            {'{', '}'},
-            {'[', ']'}
-        };
-
-        // 情况 A: 光标位于一对已存在的配对括号之间 -> 插入三行结构并把光标放在中间行
-        if (pairs.contains(leftChar) && pairs[leftChar] == rightChar) {
-            // 当前行前导空白
-            QString currentLine = cursor.block().text();
-            QString baseIndent;
-            for (QChar c : currentLine) {
-                if (c == ' ' || c == '\t') baseIndent.append(c);
-                else break;
-            }
+QList<int> CodeEditor::markedLines(int marker) const
+{
+    QList<int> lines;
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+        if (lineMarkers(block) & marker)
+            lines.append(block.blockNumber());
+    }
+    return lines;
+}
 
-            // 插入文本：\n + baseIndent + indentUnit  （用户编写代码的行）
-            //             \n + baseIndent          （右括号所在行）
-            int insertPos = cursor.position();
-            QString toInsert = "\n" + baseIndent + indentUnit + "\n" + baseIndent;
+void CodeEditor::toggleBreakpoint(const QTextBlock &block)
+{
+    if (!block.isValid()) return;
+    const bool on = !(lineMarkers(block) & BlockData::BreakpointMarker);
+    setLineMarker(block, BlockData::BreakpointMarker, on);
+    emit breakpointToggled(block.blockNumber(), on);
+}
 
-            cursor.beginEditBlock();
-            cursor.insertText(toInsert);
-            cursor.endEditBlock();
+void CodeEditor::setExecutionLine(int line)
+{
+    if (!executionLine.isNull()) {
+        setLineMarker(executionLine.block(), BlockData::ExecutionMarker, false);
+        executionLine = QTextCursor();
+    }
 
-            // 将光标放在中间那行（也就是插入点后的：1 + baseIndent + indentUnit）
-            int desiredPos = insertPos + 1 + baseIndent.length() + indentUnit.length();
-            QTextCursor newCursor(document());
-            newCursor.setPosition(desiredPos);
-            setTextCursor(newCursor);
-            return;
+    const QTextBlock block = document()->findBlockByNumber(line);
+    if (line >= 0 && block.isValid()) {
+        executionLine = QTextCursor(block);
+        setLineMarker(block, BlockData::ExecutionMarker, true);
+    }
+    highlightCurrentLine();
+}
+
+void CodeEditor::updateGutterRow(const QTextBlock &block)
+{
+    if (!block.isVisible()) return;
+    const QRectF rect = blockBoundingGeometry(block).translated(contentOffset());
+    lineNumberArea->update(0, qFloor(rect.top()), lineNumberArea->width(), qCeil(rect.height()) + 1);
+}
+
+// ---------------- 代码折叠 ----------------
+
+bool CodeEditor::isFoldable(const QTextBlock &block) const
+{
+    const BlockData *data = static_cast<const BlockData*>(block.userData());
+    if (!data || data->foldKind == BlockData::NoFold) return false;
+
+    // 只看下一行即可判断区域内是否有可隐藏的行，绘制行号区时不必向后扫描
+    const QTextBlock next = block.next();
+    if (!next.isValid()) return false;
+    switch (data->foldKind) {
+    case BlockData::BraceFold: {
+        const BlockData *nextData = static_cast<const BlockData*>(next.userData());
+        return !nextData || nextData->minBraceDepth > data->minBraceDepth;
+    }
+    case BlockData::PreprocessorFold:
+        return CppHighlighter::statePreprocessorDepth(next.userState())
+               >= CppHighlighter::statePreprocessorDepth(block.userState());
+    default:
+        return true;
+    }
+}
+
+bool CodeEditor::isFolded(const QTextBlock &block) const
+{
+    const BlockData *data = static_cast<const BlockData*>(block.userData());
+    return data && data->folded;
+}
+
+QTextBlock CodeEditor::foldRegionStop(const QTextBlock &start) const
+{
+    const BlockData *data = static_cast<const BlockData*>(start.userData());
+    if (!data) return start.next();
+
+    QTextBlock block = start.next();
+    switch (data->foldKind) {
+    case BlockData::BraceFold:
+        // 花括号深度回落到起始行最低点时结束，右括号所在行保持可见
+        for (; block.isValid(); block = block.next()) {
+            const BlockData *d = static_cast<const BlockData*>(block.userData());
+            if (d && d->minBraceDepth <= data->minBraceDepth) return block;
+        }
+        return block;
+    case BlockData::CommentFold:
+        // 注释结束行一并隐藏
+        for (; block.isValid(); block = block.next()) {
+            if (!CppHighlighter::stateInComment(block.userState())) return block.next();
         }
+        return block;
+    case BlockData::PreprocessorFold: {
+        const int level = CppHighlighter::statePreprocessorDepth(start.userState());
+        for (; block.isValid(); block = block.next()) {
+            if (CppHighlighter::statePreprocessorDepth(block.userState()) < level) return block;
+        }
+        return block;
+    }
+    case BlockData::NoFold:
+        break;
+    }
+    return start.next();
+}
 
-        // 情况 B: 普通换行时继承缩进，如果上一行以 '{' 结尾则额外缩进
-        QString currentLine = cursor.block().text();
-        QString baseIndent;
-        for (QChar c : currentLine) {
-            if (c == ' ' || c == '\t') baseIndent.append(c);
-            else break;
+void CodeEditor::relayoutBlocks(const QTextBlock &from, const QTextBlock &stop)
+{
+    const int end = stop.isValid() ? stop.position() : document()->characterCount();
+    document()->markContentsDirty(from.position(), end - from.position());
+    viewport()->update();
+    lineNumberArea->update();
+}
+
+void CodeEditor::foldBlock(const QTextBlock &block)
+{
+    if (!isFoldable(block) || isFolded(block)) return;
+
+    const QTextBlock stop = foldRegionStop(block);
+    for (QTextBlock b = block.next(); b.isValid() && b != stop; b = b.next())
+        b.setVisible(false);
+    static_cast<BlockData*>(block.userData())->folded = true;
+
+    // 光标若落在被隐藏的行中，移到折叠起始行末尾
+    if (!textCursor().block().isVisible()) {
+        QTextCursor cursor = textCursor();
+        cursor.setPosition(block.position() + block.length() - 1);
+        setTextCursor(cursor);
+    }
+
+    relayoutBlocks(block, stop);
+}
+
+void CodeEditor::unfoldBlock(const QTextBlock &block)
+{
+    if (!isFolded(block)) return;
+    static_cast<BlockData*>(block.userData())->folded = false;
+
+    const QTextBlock stop = foldRegionStop(block);
+    QTextBlock b = block.next();
+    while (b.isValid() && b != stop) {
+        b.setVisible(true);
+        // 内层仍处于折叠状态的区域保持隐藏
+        if (isFolded(b)) {
+            b = foldRegionStop(b);
+            continue;
         }
+        b = b.next();
+    }
 
-        // 先执行默认换行
-        QPlainTextEdit::keyPressEvent(event);
+    relayoutBlocks(block, stop);
+}
 
-        // 插入继承的缩进
-        cursor = textCursor();
-        cursor.insertText(baseIndent);
+void CodeEditor::toggleFold(const QTextBlock &block)
+{
+    if (isFolded(block))
+        unfoldBlock(block);
+    else
+        foldBlock(block);
+}
+
+void CodeEditor::lineNumberAreaMousePress(QMouseEvent *event)
+{
+    if (event->button() != Qt::LeftButton) return;
+
+    // 行号区与视口的纵坐标一致
+    const QTextBlock block = cursorForPosition(QPoint(0, int(event->position().y()))).block();
+
+    // 折叠标记左边（标记列和行号）点击切换断点
+    if (event->position().x() < lineNumberArea->width() - foldMarkerWidth()) {
+        toggleBreakpoint(block);
+        return;
+    }
+    if (isFoldable(block) || isFolded(block))
+        toggleFold(block);
+}
+
+QList<int> CodeEditor::foldedLines() const
+{
+    QList<int> lines;
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next()) {
+        if (isFolded(block))
+            lines.append(block.blockNumber());
+    }
+    return lines;
+}
+
+void CodeEditor::setFoldedLines(const QList<int> &lines)
+{
+    if (lines.isEmpty()) return;
+
+    if (!highlighter->isFullyHighlighted()) {
+        // 折叠依赖块数据，等后台高亮补齐后再应用
+        connect(highlighter, &CppHighlighter::highlightingFinished, this,
+                [this, lines]() { setFoldedLines(lines); }, Qt::SingleShotConnection);
+        return;
+    }
+
+    // 从后往前折叠：内层区域先折叠，外层折叠时不会把光标挪进已隐藏的内层
+    QList<int> sorted = lines;
+    std::sort(sorted.begin(), sorted.end(), std::greater<int>());
+    for (int line : sorted) {
+        const QTextBlock block = document()->findBlockByNumber(line);
+        if (block.isValid())
+            foldBlock(block);
+    }
+}
 
-        // 如果上一行以 { 结尾（忽略尾部空白），再额外插入一个缩进单位
-        if (currentLine.trimmed().endsWith("{")) {
-            cursor.insertText(indentUnit);
+void CodeEditor::checkFoldsAfterEdit(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+
+    // 折叠起始行被编辑到不再可折叠时，把其后隐藏的行放出来
+    QTextBlock first = document()->findBlock(position);
+    if (first.previous().isValid()) first = first.previous();
+    const QTextBlock last = document()->findBlock(position + charsAdded);
+
+    for (QTextBlock block = first; block.isValid(); block = block.next()) {
+        const QTextBlock next = block.next();
+        if (block.isVisible() && next.isValid() && !next.isVisible() &&
+            !(isFolded(block) && isFoldable(block))) {
+            if (BlockData *data = static_cast<BlockData*>(block.userData()))
+                data->folded = false;
+            QTextBlock b = next;
+            for (; b.isValid() && !b.isVisible(); b = b.next())
+                b.setVisible(true);
+            relayoutBlocks(block, b);
+        }
+        if (block == last) break;
+    }
+}
+
+void CodeEditor::revealCursorBlock()
+{
+    // 查找跳转等把光标移进折叠区域时自动展开
+    QTextBlock block = textCursor().block();
+    int guard = 0;
+    while (!block.isVisible() && guard++ < 64) {
+        QTextBlock start = block.previous();
+        while (start.isValid() && !(start.isVisible() && isFolded(start)))
+            start = start.previous();
+        if (!start.isValid()) {
+            block.setVisible(true);
+            relayoutBlocks(block, block.next());
+            break;
         }
+        unfoldBlock(start);
+    }
+}
 
+// ---------------- 会话恢复 ----------------
+
+void CodeEditor::setPlainTextCached(const QString &text, const QVector<int> &blockStates)
+{
+    highlighter->setCachedStates(blockStates);
+    setPlainText(text);
+}
+
+void CodeEditor::formatAfterCachedLoad()
+{
+    // 可见区域（前后各留一屏）同步补齐，其余交给后台分片
+    const int lines = qMax(1, viewport()->height() / qMax(1, fontMetrics().height()));
+    QTextBlock from = firstVisibleBlock();
+    for (int i = 0; i < lines && from.previous().isValid(); ++i)
+        from = from.previous();
+    highlighter->formatInBackground(from, lines * 3);
+}
+
+int CodeEditor::firstVisibleBlockNumber() const
+{
+    return firstVisibleBlock().blockNumber();
+}
+
+int CodeEditor::lastVisibleBlockNumber() const
+{
+    const qreal bottom = viewport()->height();
+    QTextBlock last = firstVisibleBlock();
+    for (QTextBlock block = last; block.isValid(); block = block.next()) {
+        if (!block.isVisible()) continue;
+        if (blockBoundingGeometry(block).translated(contentOffset()).top() >= bottom) break;
+        last = block;
+    }
+    return last.blockNumber();
+}
+
+void CodeEditor::scrollBlockToCenter(int blockNumber)
+{
+    QTextBlock block = document()->findBlockByNumber(qBound(0, blockNumber, blockCount() - 1));
+    while (!block.isVisible() && block.previous().isValid())
+        block = block.previous();
+
+    // 滚动条以显示行为单位，折叠掉的块不占行
+    const int lines = qMax(1, viewport()->height() / qMax(1, fontMetrics().height()));
+    QScrollBar *bar = verticalScrollBar();
+    bar->setValue(qBound(bar->minimum(), block.firstLineNumber() - lines / 2, bar->maximum()));
+}
+
+QVector<int> CodeEditor::blockStates() const
+{
+    QVector<int> states;
+    if (!highlighter->isFullyHighlighted()) return states;
+
+    states.reserve(blockCount());
+    for (QTextBlock block = document()->begin(); block.isValid(); block = block.next())
+        states.append(block.userState());
+    return states;
+}
+
+// ---------------- 自动补全括号 ----------------
+void CodeEditor::keyPressEvent(QKeyEvent *event)
+{
+    // ---------- 补全弹窗可见时，确认/取消键交给弹窗处理 ----------
+    if (completer->popup()->isVisible()) {
+        switch (event->key()) {
+        case Qt::Key_Enter:
+        case Qt::Key_Return:
+        case Qt::Key_Escape:
+        case Qt::Key_Tab:
+        case Qt::Key_Backtab:
+            event->ignore();
+            return;
+        default:
+            break;
+        }
+    }
+
+    // ---------- 行内建议：Tab 接受、Ctrl+→ 接受一个词、Esc 放弃 ----------
+    if (!ghost.isEmpty()) {
+        if (event->key() == Qt::Key_Tab && event->modifiers() == Qt::NoModifier) {
+            acceptGhostText(false);
+            return;
+        }
+        if (event->key() == Qt::Key_Right && event->modifiers() == Qt::ControlModifier) {
+            acceptGhostText(true);
+            return;
+        }
+        if (event->key() == Qt::Key_Escape) {
+            clearGhostText();
+            return;
+        }
+    }
+
+    // ---------- 多光标：Ctrl+D 选中下一处、Ctrl+Alt+上/下 添加光标、Esc 退出 ----------
+    if (event->key() == Qt::Key_D && event->modifiers() == Qt::ControlModifier) {
+        selectNextOccurrence();
+        return;
+    }
+    if ((event->key() == Qt::Key_Up || event->key() == Qt::Key_Down) &&
+        event->modifiers() == (Qt::ControlModifier | Qt::AltModifier)) {
+        QTextCursor cursor = textCursor();
+        cursor.clearSelection();
+        if (cursor.movePosition(event->key() == Qt::Key_Up ? QTextCursor::Up : QTextCursor::Down))
+            addCursor(cursor);
+        return;
+    }
+    if (!secondaryCursors.isEmpty()) {
+        if (event->key() == Qt::Key_Escape) {
+            clearExtraCursors();
+            return;
+        }
+        if (handleMultiCursorKey(event)) return;
+    }
+
+    // ---------- Ctrl+Space: 立即显示本地补全，并向语言服务器请求 ----------
+    if (event->key() == Qt::Key_Space && (event->modifiers() & Qt::ControlModifier)) {
+        lspCompletions.clear();
+        refreshCompletions(true);
+        emit completionRequested(textCursor().position());
+        return;
+    }
+
+    // ---------- Home：先到本行第一个非空白字符，再按一次回到行首 ----------
+    if (event->key() == Qt::Key_Home && !(event->modifiers() & (Qt::ControlModifier | Qt::AltModifier))) {
+        QTextCursor home = textCursor();
+        moveToSmartHome(home, (event->modifiers() & Qt::ShiftModifier) ? QTextCursor::KeepAnchor
+                                                                       : QTextCursor::MoveAnchor);
+        setTextCursor(home);
+        return;
+    }
+
+    QTextCursor cursor = textCursor();
+    QChar ch = event->text().isEmpty() ? QChar() : event->text().at(0);
+
+    // 缩进单位（你可以改成 "\t" 或更短/更长的空格）
+    const QString indentUnit = "\t";  // 一个制表符
+
+
+    // ---------- Enter 与括号：智能换行、自动配对、跳过右侧已有的右括号 ----------
+    cursor.beginEditBlock();
+    const bool typed = !isReadOnly() && smartInsert(cursor, event);
+    cursor.endEditBlock();
+    if (typed) {
         setTextCursor(cursor);
         return;
     }
@@ -361,24 +980,9 @@ void CodeEditor::keyPressEvent(QKeyEvent *event)
     if (event->key() == Qt::Key_Tab && !(event->modifiers() & Qt::ShiftModifier)) {
         cursor = textCursor();
         if (cursor.hasSelection()) {
-            int start = cursor.selectionStart();
-            int end = cursor.selectionEnd();
-
             cursor.beginEditBlock();
-
-            QTextCursor tmp(document());
-            tmp.setPosition(start);
-            int firstBlock = tmp.blockNumber();
-            tmp.setPosition(end);
-            int lastBlock = tmp.blockNumber();
-
-            for (int i = firstBlock; i <= lastBlock; ++i) {
-                QTextBlock block = document()->findBlockByNumber(i);
-                QTextCursor c(block);
-                c.movePosition(QTextCursor::StartOfBlock);
-                c.insertText(indentUnit);
-            }
-
+            indentLines(document()->findBlock(cursor.selectionStart()).blockNumber(),
+                        document()->findBlock(cursor.selectionEnd()).blockNumber());
             cursor.endEditBlock();
         } else {
             // 没有选中则直接插入缩进单位
@@ -395,89 +999,465 @@ void CodeEditor::keyPressEvent(QKeyEvent *event)
     if (event->key() == Qt::Key_Backtab || (event->key() == Qt::Key_Tab && (event->modifiers() & Qt::ShiftModifier))) {
         cursor = textCursor();
         if (cursor.hasSelection()) {
-            int start = cursor.selectionStart();
-            int end = cursor.selectionEnd();
-
             cursor.beginEditBlock();
+            unindentLines(document()->findBlock(cursor.selectionStart()).blockNumber(),
+                          document()->findBlock(cursor.selectionEnd()).blockNumber());
+            cursor.endEditBlock();
+        }
+        return;
+    }
 
-            QTextCursor tmp(document());
-            tmp.setPosition(start);
-            int firstBlock = tmp.blockNumber();
-            tmp.setPosition(end);
-            int lastBlock = tmp.blockNumber();
-
-            for (int i = firstBlock; i <= lastBlock; ++i) {
-                QTextBlock block = document()->findBlockByNumber(i);
-                QString line = block.text();
-                QTextCursor c(block);
-                c.movePosition(QTextCursor::StartOfBlock);
-
-                if (line.startsWith(indentUnit)) {
-                    c.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, indentUnit.length());
-                    c.removeSelectedText();
-                } else if (line.startsWith("\t")) {
-                    c.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, 1);
-                    c.removeSelectedText();
-                } else {
-                    // 若既不是完整的 indentUnit，也不是 tab，则尽量删除前导空格（最多 indentUnit.length() 个）
-                    int removeCount = 0;
-                    for (int k = 0; k < line.length() && k < indentUnit.length(); ++k) {
-                        if (line[k] == ' ') ++removeCount;
-                        else break;
-                    }
-                    if (removeCount > 0) {
-                        c.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, removeCount);
-                        c.removeSelectedText();
-                    }
-                }
+    // 其余按键按默认处理
+    QPlainTextEdit::keyPressEvent(event);
+
+    // 输入标识符字符时自动弹出/更新补全，其它字符关闭弹窗
+    if (!ch.isNull() && (ch.isLetterOrNumber() || ch == '_')) {
+        refreshCompletions(false);
+    } else if (completer->popup()->isVisible()) {
+        if (event->key() == Qt::Key_Backspace) {
+            refreshCompletions(false);
+        } else {
+            completer->popup()->hide();
+            lspCompletions.clear();
+        }
+    }
+}
+
+void CodeEditor::indentLines(int firstBlock, int lastBlock)
+{
+    const QString indentUnit = "\t";
+    for (int i = firstBlock; i <= lastBlock; ++i) {
+        QTextBlock block = document()->findBlockByNumber(i);
+        QTextCursor c(block);
+        c.movePosition(QTextCursor::StartOfBlock);
+        c.insertText(indentUnit);
+    }
+}
+
+void CodeEditor::unindentLines(int firstBlock, int lastBlock)
+{
+    const QString indentUnit = "\t";
+    for (int i = firstBlock; i <= lastBlock; ++i) {
+        QTextBlock block = document()->findBlockByNumber(i);
+        QString line = block.text();
+        QTextCursor c(block);
+        c.movePosition(QTextCursor::StartOfBlock);
+
+        if (line.startsWith(indentUnit)) {
+            c.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, indentUnit.length());
+            c.removeSelectedText();
+        } else if (line.startsWith("\t")) {
+            c.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, 1);
+            c.removeSelectedText();
+        } else {
+            // 若既不是完整的 indentUnit，也不是 tab，则尽量删除前导空格（最多 indentUnit.length() 个）
+            int removeCount = 0;
+            for (int k = 0; k < line.length() && k < indentUnit.length(); ++k) {
+                if (line[k] == ' ') ++removeCount;
+                else break;
+            }
+            if (removeCount > 0) {
+                c.movePosition(QTextCursor::NextCharacter, QTextCursor::KeepAnchor, removeCount);
+                c.removeSelectedText();
             }
+        }
+    }
+}
 
-            cursor.endEditBlock();
+// ---------------- 多光标 ----------------
+void CodeEditor::refreshCursors()
+{
+    highlightCurrentLine();   // 附加光标的选区随额外选区一起刷新
+    viewport()->update();
+}
+
+void CodeEditor::clearExtraCursors()
+{
+    if (secondaryCursors.isEmpty()) return;
+    secondaryCursors.clear();
+    refreshCursors();
+}
+
+void CodeEditor::addCursor(const QTextCursor &cursor)
+{
+    // 在已有光标处再次添加即移除该光标
+    for (int i = 0; i < secondaryCursors.size(); ++i) {
+        if (secondaryCursors.at(i).position() == cursor.position()) {
+            secondaryCursors.removeAt(i);
+            refreshCursors();
+            return;
         }
-        return;
     }
+    if (textCursor().position() == cursor.position()) return;
 
-    // ---------- 自动补全括号（保留你原有逻辑） ----------
-    QMap<QChar, QChar> brackets = {
-        {'(', ')'},
-        {'[', ']'},
-        {'{', '}'},
-        {'"', '"'},
-        {'\'', '\''},
-        {'<', '>'}
-    };
+    secondaryCursors.append(textCursor());
+    setTextCursor(cursor);
+    refreshCursors();
+}
 
-    if (brackets.contains(ch)) {
-        // 插入左括号（或引号）
-        QPlainTextEdit::keyPressEvent(event);
-        // 插入匹配的右括号
-        QChar right = brackets[ch];
-        cursor = textCursor();
-        cursor.insertText(right);
-        // 将光标移回到两者中间
-        cursor.movePosition(QTextCursor::Left);
+void CodeEditor::selectNextOccurrence()
+{
+    QTextCursor cursor = textCursor();
+    if (!cursor.hasSelection()) {
+        cursor.select(QTextCursor::WordUnderCursor);
         setTextCursor(cursor);
+        refreshCursors();
         return;
     }
 
-    // 如果输入的是右括号并且右侧已有相同的右括号，则跳过插入直接移动光标
-    if (brackets.values().contains(ch)) {
-        cursor = textCursor();
-        if (!cursor.atEnd() && cursor.document()->characterAt(cursor.position()) == ch) {
-            cursor.movePosition(QTextCursor::Right);
-            setTextCursor(cursor);
-            return;
+    // 从主光标之后往下找，到末尾回绕到开头
+    const QString needle = cursor.selectedText();
+    const QTextDocument::FindFlags flags = QTextDocument::FindCaseSensitively;
+    QTextCursor found = document()->find(needle, cursor.selectionEnd(), flags);
+    if (found.isNull()) found = document()->find(needle, 0, flags);
+    if (found.isNull() || found.selectionStart() == cursor.selectionStart()) return;
+    for (const QTextCursor &other : std::as_const(secondaryCursors)) {
+        if (other.selectionStart() == found.selectionStart()) return;   // 已经全部选中
+    }
+
+    secondaryCursors.append(cursor);
+    setTextCursor(found);
+    refreshCursors();
+}
+
+void CodeEditor::moveToSmartHome(QTextCursor &cursor, QTextCursor::MoveMode mode)
+{
+    const QString text = cursor.block().text();
+    int indent = 0;
+    while (indent < text.size() && (text.at(indent) == ' ' || text.at(indent) == '\t')) ++indent;
+    const int target = cursor.positionInBlock() == indent ? 0 : indent;
+    cursor.setPosition(cursor.block().position() + target, mode);
+}
+
+// ----------------- 列选择：以显示列计，制表符按制表位展开 -----------------
+int CodeEditor::tabColumns() const
+{
+    return qMax(1, qRound(tabStopDistance() / qMax(1, fontMetrics().horizontalAdvance(QLatin1Char(' ')))));
+}
+
+int CodeEditor::visualColumn(const QTextBlock &block, int positionInBlock) const
+{
+    const QString text = block.text();
+    const int tab = tabColumns();
+    int column = 0;
+    for (int i = 0; i < positionInBlock && i < text.size(); ++i)
+        column = text.at(i) == '\t' ? (column / tab + 1) * tab : column + 1;
+    return column;
+}
+
+int CodeEditor::positionForColumn(const QTextBlock &block, int column) const
+{
+    // 显示列落在制表符中间时取它前面的位置
+    const QString text = block.text();
+    const int tab = tabColumns();
+    int current = 0;
+    for (int i = 0; i < text.size(); ++i) {
+        const int next = text.at(i) == '\t' ? (current / tab + 1) * tab : current + 1;
+        if (next > column) return i;
+        current = next;
+    }
+    return text.size();
+}
+
+int CodeEditor::columnAt(const QPoint &pos, int *line) const
+{
+    const QTextCursor cursor = cursorForPosition(pos);
+    *line = cursor.blockNumber();
+
+    // 点在行尾之后时按字符宽度折算出虚拟列，列选择才能越过短行
+    int column = visualColumn(cursor.block(), cursor.positionInBlock());
+    if (cursor.atBlockEnd()) {
+        const int advance = qMax(1, fontMetrics().horizontalAdvance(QLatin1Char(' ')));
+        const int beyond = pos.x() - cursorRect(cursor).left();
+        if (beyond > 0) column += beyond / advance;
+    }
+    return column;
+}
+
+void CodeEditor::setColumnSelection(int fromLine, int fromColumn, int toLine, int toColumn)
+{
+    const int first = qMin(fromLine, toLine);
+    const int last = qMax(fromLine, toLine);
+
+    QList<QTextCursor> cursors;
+    for (QTextBlock block = document()->findBlockByNumber(first);
+         block.isValid() && block.blockNumber() <= last; block = block.next()) {
+        if (!block.isVisible()) continue;
+        QTextCursor cursor(block);
+        cursor.setPosition(block.position() + positionForColumn(block, fromColumn));
+        cursor.setPosition(block.position() + positionForColumn(block, toColumn), QTextCursor::KeepAnchor);
+        cursors.append(cursor);
+    }
+    if (cursors.isEmpty()) return;
+
+    // 主光标落在拖动终点所在的行
+    const QTextCursor primary = toLine >= fromLine ? cursors.takeLast() : cursors.takeFirst();
+    secondaryCursors = cursors;
+    setTextCursor(primary);
+    refreshCursors();
+}
+
+void CodeEditor::mousePressEvent(QMouseEvent *event)
+{
+    const QPoint pos = event->position().toPoint();
+    if (event->button() == Qt::LeftButton && (event->modifiers() & Qt::AltModifier)) {
+        if (event->modifiers() & Qt::ShiftModifier) {
+            // Alt+Shift：从主光标处开始列选择
+            const QTextCursor anchor = textCursor();
+            columnAnchorLine = anchor.blockNumber();
+            columnAnchorColumn = visualColumn(anchor.block(), anchor.positionInBlock());
+            int line = 0;
+            const int column = columnAt(pos, &line);
+            setColumnSelection(columnAnchorLine, columnAnchorColumn, line, column);
+        } else {
+            addCursor(cursorForPosition(pos));
         }
+        event->accept();
+        return;
     }
 
-    // 其余按键按默认处理
-    QPlainTextEdit::keyPressEvent(event);
+    // 普通单击回到单光标
+    clearExtraCursors();
+    QPlainTextEdit::mousePressEvent(event);
+}
+
+void CodeEditor::mouseMoveEvent(QMouseEvent *event)
+{
+    if (columnAnchorLine >= 0 && (event->buttons() & Qt::LeftButton)) {
+        int line = 0;
+        const int column = columnAt(event->position().toPoint(), &line);
+        setColumnSelection(columnAnchorLine, columnAnchorColumn, line, column);
+        event->accept();
+        return;
+    }
+    QPlainTextEdit::mouseMoveEvent(event);
+}
+
+void CodeEditor::mouseReleaseEvent(QMouseEvent *event)
+{
+    if (columnAnchorLine >= 0) {
+        columnAnchorLine = -1;
+        event->accept();
+        return;
+    }
+    QPlainTextEdit::mouseReleaseEvent(event);
+}
+
+void CodeEditor::paintEvent(QPaintEvent *event)
+{
+    QPlainTextEdit::paintEvent(event);
+    if (ghost.isEmpty() && secondaryCursors.isEmpty()) return;
+
+    QPainter painter(viewport());
+    if (!ghost.isEmpty()) paintGhostText(painter);
+
+    // 附加光标自己画（QPlainTextEdit 只画主光标），不闪烁
+    const QBrush brush = palette().text();
+    const int width = qMax(1, cursorWidth());
+    for (const QTextCursor &cursor : std::as_const(secondaryCursors)) {
+        const QRect rect = cursorRect(cursor);
+        if (rect.intersects(event->rect()))
+            painter.fillRect(rect.x(), rect.y(), width, rect.height(), brush);
+    }
+}
+
+bool CodeEditor::handleMultiCursorKey(QKeyEvent *event)
+{
+    // 只接管编辑与移动键；复制、撤销等仍按默认方式作用于主光标
+    const Qt::KeyboardModifiers mods = event->modifiers();
+    bool handled = false;
+    switch (event->key()) {
+    case Qt::Key_Return: case Qt::Key_Enter:
+    case Qt::Key_Tab: case Qt::Key_Backtab:
+    case Qt::Key_Backspace: case Qt::Key_Delete:
+    case Qt::Key_Left: case Qt::Key_Right:
+    case Qt::Key_Up: case Qt::Key_Down:
+    case Qt::Key_Home: case Qt::Key_End:
+        handled = !(mods & Qt::AltModifier);
+        break;
+    default: {
+        // 可见字符；AltGr 在 Windows 上表现为 Ctrl+Alt
+        const bool ctrlOnly = (mods & Qt::ControlModifier) && !(mods & Qt::AltModifier);
+        handled = !event->text().isEmpty() && event->text().at(0).isPrint() && !ctrlOnly;
+        break;
+    }
+    }
+    if (!handled) return false;
+
+    completer->popup()->hide();
+
+    QList<QTextCursor> cursors = secondaryCursors;
+    cursors.prepend(textCursor());
+
+    // 所有光标的修改进入同一个编辑块：撤销为一步，布局与 contentsChange 只在结束时发生一次。
+    // 光标都挂在同一文档上，前面的光标插入或删除后，后面的光标位置自动跟着调整
+    const bool blockIndent = event->key() == Qt::Key_Tab || event->key() == Qt::Key_Backtab;
+    QSet<int> indentBlocks;   // 块缩进按行去重：多个选区落在同一行（如列选择）时只缩进一次
+
+    QTextCursor batch(document());
+    batch.beginEditBlock();
+    for (QTextCursor &cursor : cursors) {
+        if (blockIndent && cursor.hasSelection()) {
+            const int first = document()->findBlock(cursor.selectionStart()).blockNumber();
+            const int last = document()->findBlock(cursor.selectionEnd()).blockNumber();
+            for (int line = first; line <= last; ++line)
+                indentBlocks.insert(line);
+            continue;
+        }
+        applyKeyToCursor(cursor, event);
+    }
+    for (int line : std::as_const(indentBlocks)) {
+        if (event->key() == Qt::Key_Tab)
+            indentLines(line, line);
+        else
+            unindentLines(line, line);
+    }
+    batch.endEditBlock();
+
+    // 移动或删除后重合的光标合并为一个（主光标优先保留）
+    QList<QTextCursor> merged;
+    QSet<int> positions;
+    for (const QTextCursor &cursor : std::as_const(cursors)) {
+        if (positions.contains(cursor.position())) continue;
+        positions.insert(cursor.position());
+        merged.append(cursor);
+    }
+
+    setTextCursor(merged.takeFirst());
+    secondaryCursors = merged;
+    ensureCursorVisible();
+    refreshCursors();
+    return true;
+}
+
+void CodeEditor::applyKeyToCursor(QTextCursor &cursor, QKeyEvent *event)
+{
+    // 智能换行和括号配对与单光标共用 smartInsert；块缩进由调用方统一处理
+    const QString indentUnit = "\t";
+    const Qt::KeyboardModifiers mods = event->modifiers();
+    const QTextCursor::MoveMode mode = (mods & Qt::ShiftModifier) ? QTextCursor::KeepAnchor
+                                                                  : QTextCursor::MoveAnchor;
+    const bool byWord = mods & Qt::ControlModifier;
+
+    switch (event->key()) {
+    case Qt::Key_Left:
+        if (mode == QTextCursor::MoveAnchor && cursor.hasSelection() && !byWord)
+            cursor.setPosition(cursor.selectionStart());
+        else
+            cursor.movePosition(byWord ? QTextCursor::PreviousWord : QTextCursor::Left, mode);
+        return;
+    case Qt::Key_Right:
+        if (mode == QTextCursor::MoveAnchor && cursor.hasSelection() && !byWord)
+            cursor.setPosition(cursor.selectionEnd());
+        else
+            cursor.movePosition(byWord ? QTextCursor::NextWord : QTextCursor::Right, mode);
+        return;
+    case Qt::Key_Up:
+        cursor.movePosition(QTextCursor::Up, mode);
+        return;
+    case Qt::Key_Down:
+        cursor.movePosition(QTextCursor::Down, mode);
+        return;
+    case Qt::Key_Home:
+        if (byWord)
+            cursor.movePosition(QTextCursor::Start, mode);
+        else
+            moveToSmartHome(cursor, mode);
+        return;
+    case Qt::Key_End:
+        cursor.movePosition(QTextCursor::EndOfLine, mode);
+        return;
+    case Qt::Key_Backspace:
+        if (!cursor.hasSelection() && byWord)
+            cursor.movePosition(QTextCursor::PreviousWord, QTextCursor::KeepAnchor);
+        if (cursor.hasSelection())
+            cursor.removeSelectedText();
+        else
+            cursor.deletePreviousChar();
+        return;
+    case Qt::Key_Delete:
+        if (!cursor.hasSelection() && byWord)
+            cursor.movePosition(QTextCursor::NextWord, QTextCursor::KeepAnchor);
+        if (cursor.hasSelection())
+            cursor.removeSelectedText();
+        else
+            cursor.deleteChar();
+        return;
+    case Qt::Key_Return:
+    case Qt::Key_Enter:
+        smartInsert(cursor, event);
+        return;
+    case Qt::Key_Tab:
+        cursor.insertText(indentUnit);   // 有选区的块缩进由调用方按行去重后统一处理
+        return;
+    case Qt::Key_Backtab:
+        return;
+    default:
+        break;
+    }
+
+    if (!smartInsert(cursor, event))
+        cursor.insertText(event->text());
+}
+
+bool CodeEditor::smartInsert(QTextCursor &cursor, QKeyEvent *event)
+{
+    const QString indentUnit = "\t";
+
+    // Enter：光标在一对括号中间时展开成三行，否则继承缩进，'{' 结尾的行再多缩进一级
+    if (event->key() == Qt::Key_Return || event->key() == Qt::Key_Enter) {
+        cursor.removeSelectedText();
+        const QString currentLine = cursor.block().text();
+        QString baseIndent;
+        for (QChar c : currentLine) {
+            if (c == ' ' || c == '\t') baseIndent.append(c);
+            else break;
+        }
+
+        const int pos = cursor.position();
+        const QChar leftChar = (pos > 0) ? document()->characterAt(pos - 1) : QChar();
+        const QChar rightChar = document()->characterAt(pos);
+        const bool betweenPair = (leftChar == '(' && rightChar == ')') ||
+                                 (leftChar == '{' && rightChar == '}') ||
+                                 (leftChar == '[' && rightChar == ']');
+        if (betweenPair) {
+            cursor.insertText("\n" + baseIndent + indentUnit + "\n" + baseIndent);
+            cursor.setPosition(pos + 1 + baseIndent.length() + indentUnit.length());
+        } else {
+            QString toInsert = "\n" + baseIndent;
+            if (currentLine.trimmed().endsWith("{")) toInsert += indentUnit;
+            cursor.insertText(toInsert);
+        }
+        return true;
+    }
+
+    const QString text = event->text();
+    if (text.isEmpty()) return false;
+    const QChar ch = text.at(0);
+    static const QHash<QChar, QChar> brackets = {
+        {'(', ')'}, {'[', ']'}, {'{', '}'}, {'"', '"'}, {'\'', '\''}, {'<', '>'}
+    };
+
+    // 左括号或引号：成对插入，光标留在中间
+    if (brackets.contains(ch)) {
+        cursor.insertText(QString(ch) + brackets.value(ch));
+        cursor.movePosition(QTextCursor::Left);
+        return true;
+    }
+    // 右侧已是同一个右括号：跳过
+    if (!cursor.hasSelection() && !cursor.atEnd() && document()->characterAt(cursor.position()) == ch &&
+        (ch == ')' || ch == ']' || ch == '}' || ch == '>')) {
+        cursor.movePosition(QTextCursor::Right);
+        return true;
+    }
+    return false;
 }
 
 // ---------------- LineNumberArea ----------------
 LineNumberArea::LineNumberArea(CodeEditor *editor) : QWidget(editor), codeEditor(editor)
 {
     setMouseTracking(true);
+    setAttribute(Qt::WA_OpaquePaintEvent);   // 绘制时会先填充脏区域背景
 }
 
 QSize LineNumberArea::sizeHint() const
@@ -492,10 +1472,115 @@ void LineNumberArea::paintEvent(QPaintEvent *event)
 
 bool LineNumberArea::event(QEvent *e)
 {
-    if (e->type() == QEvent::MouseButtonPress ||
-        e->type() == QEvent::MouseButtonDblClick ||
+    if (e->type() == QEvent::MouseButtonPress) {
+        codeEditor->lineNumberAreaMousePress(static_cast<QMouseEvent*>(e));
+        return true;
+    }
+    if (e->type() == QEvent::MouseButtonDblClick ||
         e->type() == QEvent::MouseButtonRelease) {
         return true;
     }
     return QWidget::event(e);
 }
+
+// ---------------- 行内建议 ----------------
+
+void CodeEditor::setGhostText(int position, const QString &text)
+{
+    if (text.isEmpty() || position != textCursor().position() || textCursor().hasSelection()) {
+        clearGhostText();
+        return;
+    }
+    ghost = text;
+    ghostPosition = position;
+    ghostRevision = document()->revision();
+    viewport()->update();
+}
+
+void CodeEditor::clearGhostText()
+{
+    if (ghost.isEmpty()) return;
+    ghost.clear();
+    ghostPosition = -1;
+    viewport()->update();
+}
+
+void CodeEditor::onGhostContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    if (ghost.isEmpty() || document()->revision() == ghostRevision) return;   // 高亮器的格式刷新
+
+    // 正好在建议处输入了建议的开头：吃掉这部分，其余继续显示
+    if (charsRemoved == 0 && position == ghostPosition && charsAdded > 0 && charsAdded <= ghost.size()) {
+        bool matches = true;
+        for (int i = 0; i < charsAdded && matches; ++i)
+            matches = document()->characterAt(position + i) == ghost.at(i);
+        if (matches) {
+            ghost.remove(0, charsAdded);
+            ghostPosition += charsAdded;
+            ghostRevision = document()->revision();
+            if (ghost.isEmpty()) ghostPosition = -1;
+            viewport()->update();
+            return;
+        }
+    }
+    clearGhostText();
+}
+
+void CodeEditor::acceptGhostText(bool oneWord)
+{
+    QString text = ghost;
+    if (oneWord) {
+        auto isWord = [](QChar ch) { return ch.isLetterOrNumber() || ch == '_'; };
+        int end = 0;
+        while (end < text.size() && !isWord(text.at(end))) ++end;
+        while (end < text.size() && isWord(text.at(end))) ++end;
+        text = text.left(qMax(1, end));
+    }
+
+    // 插入的正是建议的开头，onGhostContentsChange 会把剩余部分保留下来
+    QTextCursor cursor = textCursor();
+    cursor.setPosition(ghostPosition);
+    cursor.insertText(text);
+    setTextCursor(cursor);
+}
+
+void CodeEditor::paintGhostText(QPainter &painter)
+{
+    if (ghostPosition < 0 || ghostPosition >= document()->characterCount()) return;
+    QTextCursor cursor(document());
+    cursor.setPosition(ghostPosition);
+    const QRect rect = cursorRect(cursor);
+
+    const QFontMetrics metrics(font());
+    const QString tab(qMax(1, qRound(tabStopDistance() / qMax(1, metrics.horizontalAdvance(' ')))), ' ');
+    QStringList lines = ghost.split('\n');
+    for (QString &line : lines)
+        line.replace('\t', tab);
+
+    painter.setFont(font());
+    painter.setPen(QColor(140, 140, 140));
+
+    // 第一行接在光标之后
+    painter.drawText(rect.left() + 1, rect.top() + metrics.ascent(), lines.first());
+
+    // 其余行画在下方的浮层里：遮住原有几行，但不改变排版
+    if (lines.size() > 1) {
+        const int left = qRound(contentOffset().x() + document()->documentMargin());
+        int width = 0;
+        for (int i = 1; i < lines.size(); ++i)
+            width = qMax(width, metrics.horizontalAdvance(lines.at(i)));
+        const QRect box(left, rect.bottom() + 1, width + 8, metrics.lineSpacing() * (lines.size() - 1));
+        painter.fillRect(box, viewport()->palette().base());
+        int y = box.top() + metrics.ascent();
+        for (int i = 1; i < lines.size(); ++i) {
+            painter.drawText(left, y, lines.at(i));
+            y += metrics.lineSpacing();
+        }
+    }
+}
+
+void CodeEditor::focusOutEvent(QFocusEvent *event)
+{
+    clearGhostText();
+    QPlainTextEdit::focusOutEvent(event);
+}
@@ -9,8 +9,16 @@
 #include <QStack>
 #include <QPair>
 #include <QKeyEvent>   // 记得包含 QKeyEvent
+#include <QTextEdit>
+#include <QHash>
+#include "diagnostic.h"
+#include "gutterrenderer.h"
 
 class LineNumberArea;
+class Minimap;
+class CppHighlighter;
+class QCompleter;
+class QPainter;
 
 class CodeEditor : public QPlainTextEdit
 {
@@ -21,9 +29,89 @@ public:
     int lineNumberAreaWidth() const;
     void lineNumberAreaPaintEvent(QPaintEvent *event);
 
+    CppHighlighter *syntaxHighlighter() const { return highlighter; }
+
+    // 分栏：改用 source 的文档与高亮器，文本和高亮只有一份，视口、光标各自独立。
+    // 调用方负责让文档活得比所有视图都久
+    void shareDocumentWith(CodeEditor *source);
+
+    // 诊断以波浪线显示，悬停时给出提示
+    void setDiagnostics(const QList<Diagnostic> &list);
+    const QList<Diagnostic> &currentDiagnostics() const { return diagnostics; }
+
+    // ---------------- 代码折叠 ----------------
+    bool isFoldable(const QTextBlock &block) const;
+    bool isFolded(const QTextBlock &block) const;
+    void foldBlock(const QTextBlock &block);
+    void unfoldBlock(const QTextBlock &block);
+    void toggleFold(const QTextBlock &block);
+    int foldMarkerWidth() const;
+    void lineNumberAreaMousePress(QMouseEvent *event);
+
+    // 折叠起始行号（从 0 开始），供会话保存与恢复；高亮未完成时折叠推迟到完成后
+    QList<int> foldedLines() const;
+    void setFoldedLines(const QList<int> &lines);
+
+    // ---------------- 会话恢复 ----------------
+    // 载入文本并套用缓存的块状态：首帧前不做正则高亮，可见区域随后优先补齐
+    void setPlainTextCached(const QString &text, const QVector<int> &blockStates);
+    QVector<int> blockStates() const;   // 高亮尚未完成时返回空
+
+    // 行号区标记（断点、执行位置等），marker 取 BlockData::Marker
+    void setLineMarker(const QTextBlock &block, int marker, bool on);
+    int lineMarkers(const QTextBlock &block) const;
+    QList<int> markedLines(int marker) const;          // 带有该标记的行号（从 0 开始）
+
+    // ---------------- 调试 ----------------
+    // 断点随所在行移动；点击行号区或调用 toggleBreakpoint 切换，发出 breakpointToggled
+    void toggleBreakpoint(const QTextBlock &block);
+    // 调试器停下的行：行号区画箭头并整行高亮；-1 清除
+    void setExecutionLine(int line);
+
+    // 搜索结果同步到小地图的概览标尺
+    void setSearchHits(const QList<QTextCursor> &hits);
+
+    // 小地图按块号绘制：视口首尾两个可见块的块号（中间可能隔着折叠区），
+    // 以及把某块（落在折叠区内时取折叠起始行）滚到视口中央
+    int firstVisibleBlockNumber() const;
+    int lastVisibleBlockNumber() const;
+    void scrollBlockToCenter(int blockNumber);
+
+    // 待审阅修改的行高亮（见 DiffReview）
+    void setReviewSelections(const QList<QTextEdit::ExtraSelection> &selections);
+
+    // 语言服务器返回的补全候选（position 为发起请求时的光标位置），与本地索引合并显示
+    void showCompletions(int position, const QStringList &items);
+
+    // ---------------- 行内建议（灰色提示） ----------------
+    // 只画在视口上，不进入文档；Tab 接受、Ctrl+→ 接受一个词、Esc 放弃。
+    // 继续输入与建议开头相同的字符时建议随之缩短，光标移开或其他编辑则清除。
+    void setGhostText(int position, const QString &text);
+    void clearGhostText();
+    QString ghostText() const { return ghost; }
+
+    // ---------------- 多光标 ----------------
+    // 主光标即 textCursor()；其余光标随文档编辑自动移动
+    void addCursor(const QTextCursor &cursor);   // 新光标成为主光标，原主光标降为附加光标
+    void selectNextOccurrence();                 // Ctrl+D
+    void clearExtraCursors();
+    int cursorCount() const { return secondaryCursors.size() + 1; }
+
+signals:
+    void completionRequested(int position);
+    void hoverRequested(int position, const QPoint &globalPos);
+    void breakpointToggled(int line, bool on);          // line 从 0 开始
+
 protected:
     void resizeEvent(QResizeEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;  // <-- 加上这一行
+    bool viewportEvent(QEvent *event) override;
+    void changeEvent(QEvent *event) override;
+    void paintEvent(QPaintEvent *event) override;
+    void focusOutEvent(QFocusEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+    void mouseReleaseEvent(QMouseEvent *event) override;
 
 private slots:
     void updateLineNumberAreaWidth(int newBlockCount);
@@ -32,11 +120,62 @@ private slots:
     void updateLineNumberArea(const QRect &rect, int dy);
     void wheelEvent(QWheelEvent *event);
 
+    void insertCompletion(const QString &completion);
+    void checkFoldsAfterEdit(int position, int charsRemoved, int charsAdded);
+    void revealCursorBlock();
+    void formatAfterCachedLoad();
+
 private:
     QWidget *lineNumberArea;
+    Minimap *minimap = nullptr;
+    CppHighlighter *highlighter = nullptr;
+    QCompleter *completer = nullptr;
+
+    QStringList lspCompletions;          // 最近一次语言服务器补全结果
+
+    QList<Diagnostic> diagnostics;
+    QList<QTextEdit::ExtraSelection> diagnosticSelections;
+    QHash<int, int> diagnosticLines;     // 行号 -> 最严重的诊断级别
+    QList<QTextEdit::ExtraSelection> reviewSelections;
+    QTextCursor executionLine;           // 调试器当前行，为空表示没有
+
+    QString ghost;                       // 行内建议，尚未插入的部分
+    int ghostPosition = -1;
+    int ghostRevision = -1;              // 文档未真正修改时（仅格式刷新）保留建议
+    void onGhostContentsChange(int position, int charsRemoved, int charsAdded);
+    void acceptGhostText(bool oneWord);
+    void paintGhostText(QPainter &painter);
+
+    GutterRenderer gutter;
+
+    QList<QTextCursor> secondaryCursors;   // 主光标之外的光标
+    int columnAnchorLine = -1;             // Alt+Shift 拖动列选择的起点
+    int columnAnchorColumn = 0;
 
     void highlightMatchingBrackets();
     bool isInCommentOrString(int pos) const;  // 判断当前位置是否在注释或字符串
+    void applyExtraSelections(QList<QTextEdit::ExtraSelection> selections);
+    bool diagnosticRange(const Diagnostic &diagnostic, int *start, int *end) const;
+    QString wordBeforeCursor() const;
+    QTextBlock foldRegionStop(const QTextBlock &start) const;   // 折叠区域之后第一个保持可见的块
+    void relayoutBlocks(const QTextBlock &from, const QTextBlock &stop);
+    void refreshCompletions(bool force);
+    void updateGutterRow(const QTextBlock &block);
+    void connectDocument();
+
+    // 多光标编辑：按键对每个光标各执行一次，全部修改在同一个编辑块内完成
+    bool handleMultiCursorKey(QKeyEvent *event);
+    void applyKeyToCursor(QTextCursor &cursor, QKeyEvent *event);
+    bool smartInsert(QTextCursor &cursor, QKeyEvent *event);   // 智能换行与括号配对，单光标和多光标共用
+    void refreshCursors();
+    void setColumnSelection(int fromLine, int fromColumn, int toLine, int toColumn);   // 列为显示列
+    int columnAt(const QPoint &pos, int *line) const;
+    int tabColumns() const;                                   // 一个制表位占几列
+    int visualColumn(const QTextBlock &block, int positionInBlock) const;
+    int positionForColumn(const QTextBlock &block, int column) const;
+    static void moveToSmartHome(QTextCursor &cursor, QTextCursor::MoveMode mode);   // 单光标和多光标共用
+    void indentLines(int firstBlock, int lastBlock);
+    void unindentLines(int firstBlock, int lastBlock);
 };
 
 // ----------------------------------------------------------------------
@@ -50,7 +189,7 @@ public:
 
 protected:
     void paintEvent(QPaintEvent *event) override;
-    bool event(QEvent *e) override;  // 拦截鼠标事件，使行号不可编辑
+    bool event(QEvent *e) override;  // 拦截鼠标事件，使行号不可编辑（折叠标记除外）
 
 private:
     CodeEditor *codeEditor;
@@ -0,0 +1,141 @@
+#include "completionindex.h"
+
+#include <QCoreApplication>
+#include <QDirIterator>
+#include <QFile>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QtConcurrent>
+#include <algorithm>
+
+namespace {
+const int kMinWordLength = 2;
+const qint64 kMaxScanFileSize = 4 * 1024 * 1024;   // 超大文件（多为生成代码）不参与扫描
+}
+
+CompletionIndex::CompletionIndex(QObject *parent)
+    : QObject(parent)
+{
+}
+
+CompletionIndex *CompletionIndex::instance()
+{
+    // 挂在 qApp 下，保证比所有文档活得久
+    static CompletionIndex *index = new CompletionIndex(QCoreApplication::instance());
+    return index;
+}
+
+// ----------------- 缓冲区标识符 -----------------
+void CompletionIndex::addWords(const QStringList &words)
+{
+    for (const QString &word : words)
+        bufferWords.insert(word);
+}
+
+void CompletionIndex::removeWords(const QStringList &words)
+{
+    for (const QString &word : words)
+        bufferWords.remove(word);
+}
+
+void CompletionIndex::replaceWords(const QStringList &oldWords, const QStringList &newWords)
+{
+    // 只提交差量，避免同一行反复删除再插入相同的词
+    QHash<QString, int> delta;
+    for (const QString &word : oldWords) --delta[word];
+    for (const QString &word : newWords) ++delta[word];
+
+    for (auto it = delta.constBegin(); it != delta.constEnd(); ++it) {
+        if (it.value() > 0)
+            bufferWords.insert(it.key(), it.value());
+        else if (it.value() < 0)
+            bufferWords.remove(it.key(), -it.value());
+    }
+}
+
+QStringList CompletionIndex::complete(const QString &prefix, int limit) const
+{
+    QStringList buffered = bufferWords.complete(prefix, limit);
+    if (!projectWords) return buffered;
+
+    const QStringList project = projectWords->complete(prefix, limit);
+
+    // 两棵树各取前 K 个，按词频之和重新排序
+    QHash<QString, int> scores;
+    for (const QString &word : buffered) scores[word] += bufferWords.count(word);
+    for (const QString &word : project) scores[word] += projectWords->count(word);
+
+    QStringList merged = scores.keys();
+    std::sort(merged.begin(), merged.end(), [&](const QString &a, const QString &b) {
+        const int sa = scores.value(a);
+        const int sb = scores.value(b);
+        return sa != sb ? sa > sb : a < b;
+    });
+    if (merged.size() > limit)
+        merged.erase(merged.begin() + limit, merged.end());
+    return merged;
+}
+
+// ----------------- 标识符提取 -----------------
+QStringList CompletionIndex::extractIdentifiers(const QString &text, const QVector<bool> &skip)
+{
+    QStringList words;
+    const int length = text.length();
+    int i = 0;
+    while (i < length) {
+        const QChar c = text.at(i);
+        if (!(c.isLetter() || c == '_') || (i < skip.size() && skip.at(i))) {
+            // 跳过数字字面量中的字母，如 0x1F
+            if (c.isDigit()) {
+                while (i < length && (text.at(i).isLetterOrNumber() || text.at(i) == '_')) ++i;
+            } else {
+                ++i;
+            }
+            continue;
+        }
+
+        int end = i + 1;
+        while (end < length && (text.at(end).isLetterOrNumber() || text.at(end) == '_'))
+            ++end;
+        if (end - i >= kMinWordLength)
+            words.append(text.mid(i, end - i));
+        i = end;
+    }
+    return words;
+}
+
+// ----------------- 项目扫描 -----------------
+void CompletionIndex::indexProject(const QString &rootPath)
+{
+    const int generation = ++projectGeneration;
+    if (rootPath.isEmpty()) {
+        projectWords.reset();
+        return;
+    }
+
+    auto *watcher = new QFutureWatcher<std::shared_ptr<CompletionTrie>>(this);
+    connect(watcher, &QFutureWatcher<std::shared_ptr<CompletionTrie>>::finished, this, [=]() {
+        if (generation == projectGeneration)
+            projectWords = watcher->result();
+        watcher->deleteLater();
+    });
+
+    watcher->setFuture(QtConcurrent::run([rootPath]() {
+        QHash<QString, int> counts;
+        QDirIterator it(rootPath, {"*.c", "*.cc", "*.cpp", "*.cxx", "*.h", "*.hpp"},
+                        QDir::Files, QDirIterator::Subdirectories);
+        while (it.hasNext()) {
+            QFile file(it.next());
+            if (file.size() > kMaxScanFileSize || !file.open(QIODevice::ReadOnly)) continue;
+            const QStringList words = extractIdentifiers(QString::fromUtf8(file.readAll()));
+            for (const QString &word : words)
+                ++counts[word];
+        }
+
+        // 在工作线程里建好整棵树，主线程只做一次指针替换
+        auto trie = std::make_shared<CompletionTrie>();
+        for (auto c = counts.constBegin(); c != counts.constEnd(); ++c)
+            trie->insert(c.key(), c.value());
+        return trie;
+    }));
+}
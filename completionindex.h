@@ -0,0 +1,40 @@
+#ifndef COMPLETIONINDEX_H
+#define COMPLETIONINDEX_H
+
+#include <QObject>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "completiontrie.h"
+
+// ----------------------------------------------------------------------
+// CompletionIndex：进程内共享的标识符索引
+// bufferWords 由各文档的高亮器按块增量维护；projectWords 在后台线程扫描项目后整体替换。
+class CompletionIndex : public QObject
+{
+    Q_OBJECT
+public:
+    static CompletionIndex *instance();
+
+    void addWords(const QStringList &words);
+    void removeWords(const QStringList &words);
+    void replaceWords(const QStringList &oldWords, const QStringList &newWords);
+
+    // 合并缓冲区与项目的结果，按总词频排序
+    QStringList complete(const QString &prefix, int limit) const;
+
+    // 后台扫描项目源文件，完成后替换项目索引；重复调用时旧的扫描结果会被丢弃
+    void indexProject(const QString &rootPath);
+
+    // 从一行文本中提取标识符（跳过 skip 为 true 的位置，例如字符串内部）
+    static QStringList extractIdentifiers(const QString &text, const QVector<bool> &skip = QVector<bool>());
+
+private:
+    explicit CompletionIndex(QObject *parent = nullptr);
+
+    CompletionTrie bufferWords;
+    std::shared_ptr<CompletionTrie> projectWords;
+    int projectGeneration = 0;
+};
+
+#endif // COMPLETIONINDEX_H
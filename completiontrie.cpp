@@ -0,0 +1,210 @@
+#include "completiontrie.h"
+
+#include <queue>
+
+CompletionTrie::CompletionTrie()
+    : root(new Node)
+{
+}
+
+CompletionTrie::~CompletionTrie() = default;
+
+void CompletionTrie::clear()
+{
+    root.reset(new Node);
+    words = 0;
+}
+
+CompletionTrie::Node *CompletionTrie::findChild(const Node *node, QChar first)
+{
+    for (const auto &child : node->children) {
+        if (child->label.at(0) == first)
+            return child.get();
+    }
+    return nullptr;
+}
+
+void CompletionTrie::updateMaxCount(Node *node)
+{
+    int best = node->count;
+    for (const auto &child : node->children)
+        best = qMax(best, child->maxCount);
+    node->maxCount = best;
+}
+
+// ----------------- 插入 -----------------
+void CompletionTrie::insert(const QString &word, int count)
+{
+    if (word.isEmpty() || count <= 0) return;
+
+    std::vector<Node*> path;
+    path.push_back(root.get());
+
+    Node *node = root.get();
+    int i = 0;
+    while (i < word.size()) {
+        Node *child = findChild(node, word.at(i));
+        if (!child) {
+            // 没有同首字母的边，直接挂上剩余部分
+            std::unique_ptr<Node> leaf(new Node);
+            leaf->label = word.mid(i);
+            child = leaf.get();
+            node->children.push_back(std::move(leaf));
+            path.push_back(child);
+            node = child;
+            break;
+        }
+
+        int common = 0;
+        const int limit = qMin(child->label.size(), word.size() - i);
+        while (common < limit && child->label.at(common) == word.at(i + common))
+            ++common;
+
+        if (common < child->label.size()) {
+            // 在边的中间分裂出新节点
+            std::unique_ptr<Node> middle(new Node);
+            middle->label = child->label.left(common);
+            middle->maxCount = child->maxCount;
+
+            for (auto &slot : node->children) {
+                if (slot.get() == child) {
+                    child->label.remove(0, common);
+                    middle->children.push_back(std::move(slot));
+                    slot = std::move(middle);
+                    child = slot.get();
+                    break;
+                }
+            }
+        }
+
+        node = child;
+        i += common;
+        path.push_back(node);
+    }
+
+    if (node->count == 0) ++words;
+    node->count += count;
+
+    // 插入只会增大词频，沿路径取最大值即可
+    for (Node *n : path)
+        n->maxCount = qMax(n->maxCount, node->count);
+}
+
+// ----------------- 删除 -----------------
+void CompletionTrie::remove(const QString &word, int count)
+{
+    if (word.isEmpty() || count <= 0) return;
+
+    std::vector<Node*> path;
+    path.push_back(root.get());
+
+    Node *node = root.get();
+    int i = 0;
+    while (i < word.size()) {
+        Node *child = findChild(node, word.at(i));
+        if (!child || !QStringView(word).mid(i).startsWith(child->label)) return;
+        i += child->label.size();
+        node = child;
+        path.push_back(node);
+    }
+    if (node->count == 0) return;
+
+    node->count = qMax(0, node->count - count);
+    if (node->count == 0) --words;
+
+    // 自底向上：删掉空叶子，合并只剩一个孩子的非词尾节点，并重算最大词频
+    for (int depth = int(path.size()) - 1; depth > 0; --depth) {
+        Node *current = path[depth];
+        Node *parent = path[depth - 1];
+
+        if (current->count == 0 && current->children.empty()) {
+            for (auto it = parent->children.begin(); it != parent->children.end(); ++it) {
+                if (it->get() == current) {
+                    parent->children.erase(it);
+                    break;
+                }
+            }
+            continue;
+        }
+
+        if (current->count == 0 && current->children.size() == 1) {
+            std::unique_ptr<Node> only = std::move(current->children.front());
+            current->children.clear();
+            current->label += only->label;
+            current->count = only->count;
+            current->children = std::move(only->children);
+        }
+
+        updateMaxCount(current);
+    }
+    updateMaxCount(root.get());
+}
+
+int CompletionTrie::count(const QString &word) const
+{
+    const Node *node = root.get();
+    int i = 0;
+    while (i < word.size()) {
+        const Node *child = findChild(node, word.at(i));
+        if (!child || !QStringView(word).mid(i).startsWith(child->label)) return 0;
+        i += child->label.size();
+        node = child;
+    }
+    return node->count;
+}
+
+// ----------------- 前缀查询 -----------------
+QStringList CompletionTrie::complete(const QString &prefix, int limit) const
+{
+    QStringList result;
+    if (limit <= 0) return result;
+
+    // 先定位到覆盖整个前缀的节点（前缀可能终止在某条边的中间）
+    const Node *node = root.get();
+    QString matched;
+    int i = 0;
+    while (i < prefix.size()) {
+        const Node *child = findChild(node, prefix.at(i));
+        if (!child) return result;
+
+        const int remaining = prefix.size() - i;
+        if (remaining <= child->label.size()) {
+            if (!child->label.startsWith(QStringView(prefix).mid(i))) return result;
+        } else if (!QStringView(prefix).mid(i).startsWith(child->label)) {
+            return result;
+        }
+
+        matched += child->label;
+        i += child->label.size();
+        node = child;
+    }
+
+    // 最佳优先：节点按子树最大词频排序，词条按自身词频排序
+    struct Entry
+    {
+        int priority;
+        const Node *node;
+        QString text;
+        bool isWord;
+        bool operator<(const Entry &other) const { return priority < other.priority; }
+    };
+
+    std::priority_queue<Entry> queue;
+    queue.push({node->maxCount, node, matched, false});
+
+    while (!queue.empty() && result.size() < limit) {
+        Entry entry = queue.top();
+        queue.pop();
+
+        if (entry.isWord) {
+            result.append(entry.text);
+            continue;
+        }
+
+        if (entry.node->count > 0)
+            queue.push({entry.node->count, entry.node, entry.text, true});
+        for (const auto &child : entry.node->children)
+            queue.push({child->maxCount, child.get(), entry.text + child->label, false});
+    }
+    return result;
+}
@@ -0,0 +1,48 @@
+#ifndef COMPLETIONTRIE_H
+#define COMPLETIONTRIE_H
+
+#include <QString>
+#include <QStringList>
+#include <memory>
+#include <vector>
+
+// ----------------------------------------------------------------------
+// CompletionTrie：带词频的压缩前缀树（radix trie）
+// 每个节点记录子树中的最大词频，按前缀取前 K 个候选时做最佳优先搜索，
+// 代价只和 K 与前缀长度有关，与总词数无关。
+class CompletionTrie
+{
+public:
+    CompletionTrie();
+    ~CompletionTrie();
+
+    CompletionTrie(const CompletionTrie &) = delete;
+    CompletionTrie &operator=(const CompletionTrie &) = delete;
+
+    void insert(const QString &word, int count = 1);
+    void remove(const QString &word, int count = 1);   // 词频降为 0 时删除该词
+    int count(const QString &word) const;
+
+    // 以 prefix 开头、按词频从高到低的前 limit 个词
+    QStringList complete(const QString &prefix, int limit) const;
+
+    int size() const { return words; }
+    void clear();
+
+private:
+    struct Node
+    {
+        QString label;                             // 边上的字符串片段
+        int count = 0;                             // 以此节点结尾的词频，0 表示不是词尾
+        int maxCount = 0;                          // 子树（含自身）中的最大词频
+        std::vector<std::unique_ptr<Node>> children;
+    };
+
+    static Node *findChild(const Node *node, QChar first);
+    static void updateMaxCount(Node *node);
+
+    std::unique_ptr<Node> root;
+    int words = 0;
+};
+
+#endif // COMPLETIONTRIE_H
@@ -0,0 +1,475 @@
+#include "contextbuilder.h"
+#include "conversationhistory.h"
+#include "textfile.h"
+
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QQueue>
+#include <QRegularExpression>
+#include <algorithm>
+
+namespace {
+const int kMaxFiles = 24;            // 沿包含关系最多读取的文件数
+const int kMaxIndexedHeaders = 5000;
+const int kMaxIndexedDirs = 2000;    // 建索引时最多进入的目录数，大型源码树或构建目录不至于拖住
+const int kWholeFileTokens = 300;    // 小于此值的头文件整体附上
+const int kWindowLines = 40;         // 函数太长时只取光标上下这么多行
+
+const QSet<QString> &controlKeywords()
+{
+    static const QSet<QString> words = {
+        "if", "else", "for", "while", "do", "switch", "catch", "try", "return",
+        "namespace", "class", "struct", "union", "enum", "extern", "sizeof",
+        "alignof", "decltype", "static_cast", "dynamic_cast", "reinterpret_cast",
+        "const_cast", "new", "delete", "throw", "defined", "static_assert"
+    };
+    return words;
+}
+
+// 去掉注释、访问说明符和行首的全大写宏（Q_OBJECT 等），压成一行
+QString cleanHeader(QStringView header)
+{
+    static const QRegularExpression lineComment("//[^\n]*");
+    static const QRegularExpression blockComment("/\\*.*?\\*/", QRegularExpression::DotMatchesEverythingOption);
+    static const QRegularExpression leading(
+        "^(?:(?:public|protected|private|signals|Q_SIGNALS)(?:\\s+(?:slots|Q_SLOTS))?\\s*:(?!:)\\s*"
+        "|[A-Z_][A-Z0-9_]*\\s+(?=[A-Za-z_]))+");
+    QString result = header.toString();
+    result.remove(blockComment);
+    result.remove(lineComment);
+    result = result.simplified();
+    result.remove(leading);
+    return result;
+}
+
+// 构建输出和依赖目录里的头文件多是生成或第三方的，不进索引
+bool isSkippedDirectory(const QString &name)
+{
+    const QString lower = name.toLower();
+    return lower == "build" || lower == "_build" || lower == "out" || lower == "debug" || lower == "release"
+           || lower == "node_modules" || lower.startsWith("build-") || lower.startsWith("cmake-build-");
+}
+
+QMutex headerIndexMutex;
+QHash<QString, QHash<QString, QString>> headerIndexes;   // 项目根目录 → 索引
+
+int firstNonSpace(const QString &text, int from, int to)
+{
+    while (from < to && text.at(from).isSpace()) ++from;
+    return from;
+}
+}
+
+int ContextBuilder::SourceFile::lineAt(int position) const
+{
+    const auto it = std::upper_bound(lineStarts.cbegin(), lineStarts.cend(), position);
+    return int(it - lineStarts.cbegin());   // 从 1 开始
+}
+
+ContextBuilder::ContextBuilder(const QString &projectRoot, const QHash<QString, QString> &openBuffers)
+    : root(projectRoot)
+{
+    for (auto it = openBuffers.constBegin(); it != openBuffers.constEnd(); ++it)
+        buffers.insert(QFileInfo(it.key()).absoluteFilePath(), it.value());
+}
+
+// ----------------- 词法扫描 -----------------
+void ContextBuilder::scan(SourceFile &file)
+{
+    const QString &text = file.text;
+    const int size = text.size();
+    file.lineStarts = {0};
+
+    QVector<int> stack;              // 未闭合的块
+    int statementStart = 0;
+    bool atLineStart = true;
+    for (int i = 0; i < size; ++i) {
+        const QChar ch = text.at(i);
+        if (ch == '\n') {
+            file.lineStarts.append(i + 1);
+            atLineStart = true;
+            continue;
+        }
+        if (ch.isSpace()) continue;
+        const QChar next = i + 1 < size ? text.at(i + 1) : QChar();
+
+        // 预处理行（含续行）
+        if (ch == '#' && atLineStart) {
+            int end = i;
+            while (end < size && text.at(end) != '\n') {
+                if (text.at(end) == '\\' && end + 1 < size && text.at(end + 1) == '\n') {
+                    file.lineStarts.append(end + 2);
+                    end += 2;
+                    continue;
+                }
+                ++end;
+            }
+            static const QRegularExpression include("^#\\s*include\\s*\"([^\"]+)\"");
+            const QRegularExpressionMatch match = include.match(QStringView(text).mid(i, end - i));
+            if (match.hasMatch()) file.includes.append(match.captured(1));
+            statementStart = end;
+            i = end - 1;
+            continue;
+        }
+        atLineStart = false;
+
+        if (ch == '/' && next == '/') {
+            while (i + 1 < size && text.at(i + 1) != '\n') ++i;
+            continue;
+        }
+        if (ch == '/' && next == '*') {
+            int end = text.indexOf("*/", i + 2);
+            end = end < 0 ? size : end + 2;
+            for (int k = i; k < end; ++k) {
+                if (text.at(k) == '\n') file.lineStarts.append(k + 1);
+            }
+            i = end - 1;
+            continue;
+        }
+        if (ch == '"' || ch == '\'') {
+            int k = i + 1;
+            while (k < size && text.at(k) != ch && text.at(k) != '\n') {
+                if (text.at(k) == '\\') ++k;
+                ++k;
+            }
+            i = (k < size && text.at(k) == '\n') ? k - 1 : k;
+            continue;
+        }
+
+        if (ch == '{') {
+            Block block;
+            block.headerStart = statementStart;
+            block.open = i;
+            block.close = size;
+            block.depth = stack.size();
+            file.blocks.append(block);
+            stack.append(file.blocks.size() - 1);
+            statementStart = i + 1;
+        } else if (ch == '}') {
+            if (!stack.isEmpty()) file.blocks[stack.takeLast()].close = i;
+            statementStart = i + 1;
+        } else if (ch == ';') {
+            file.statements.append({statementStart, i + 1, int(stack.size())});
+            statementStart = i + 1;
+        }
+    }
+}
+
+bool ContextBuilder::isFunctionHeader(QStringView header)
+{
+    const int paren = header.indexOf(u'(');
+    if (paren <= 0) return false;
+
+    static const QRegularExpression firstWord("^[A-Za-z_]\\w*");
+    const QRegularExpressionMatch match = firstWord.match(header);
+    if (match.hasMatch() && controlKeywords().contains(match.captured())) return false;
+
+    // 变量初始化、lambda 赋值等
+    const QStringView before = header.left(paren);
+    if (before.contains(u'=') && !before.contains(u"operator")) return false;
+    return !declarationName(header).isEmpty();
+}
+
+QString ContextBuilder::declarationName(QStringView header)
+{
+    const int paren = header.indexOf(u'(');
+    if (paren <= 0) return QString();
+    QStringView before = header.left(paren).trimmed();
+
+    const int op = before.lastIndexOf(u"operator");
+    if (op >= 0) return before.mid(op).toString().remove(' ');
+
+    int start = before.size();
+    while (start > 0 && (before.at(start - 1).isLetterOrNumber() || before.at(start - 1) == '_'
+                         || before.at(start - 1) == '~'))
+        --start;
+    const QStringView name = before.mid(start);
+    if (name.isEmpty() || name.at(0).isDigit()) return QString();
+    return name.toString();
+}
+
+QString ContextBuilder::typeName(QStringView header)
+{
+    static const QRegularExpression type("\\b(?:class|struct|union|enum(?:\\s+class)?)\\s+"
+                                         "(?:[A-Z_][A-Z0-9_]*\\s+)?([A-Za-z_]\\w*)\\s*([^\\s])?");
+    QString name;
+    QRegularExpressionMatchIterator it = type.globalMatch(header);
+    while (it.hasNext()) {
+        const QRegularExpressionMatch match = it.next();
+        const QString following = match.captured(2);
+        if (following == ">" || following == ",") continue;   // 模板参数 class T
+        name = match.captured(1);
+    }
+    return name;
+}
+
+// ----------------- 文件与包含关系 -----------------
+QString ContextBuilder::readFile(const QString &path) const
+{
+    const auto buffer = buffers.constFind(path);
+    if (buffer != buffers.constEnd()) return buffer.value();
+
+    QString text;
+    TextFormat format;
+    QString error;
+    if (!TextFile::read(path, &text, &format, &error)) return QString();
+    return text;
+}
+
+QString ContextBuilder::resolveInclude(const QString &include, const QString &fromPath)
+{
+    QStringList paths = {QFileInfo(fromPath).dir().filePath(include)};
+    if (!root.isEmpty()) paths.append(QDir(root).filePath(include));
+    for (const QString &candidate : paths) {
+        const QString path = QFileInfo(candidate).absoluteFilePath();
+        if (buffers.contains(path) || QFileInfo::exists(path)) return path;
+    }
+
+    // 包含路径由构建系统决定：退而按文件名在项目里找
+    if (root.isEmpty()) return QString();
+    if (!headersIndexed) {
+        headersIndexed = true;
+        projectHeaders = headerIndex(root);
+    }
+    return projectHeaders.value(QFileInfo(include).fileName());
+}
+
+QHash<QString, QString> ContextBuilder::headerIndex(const QString &projectRoot)
+{
+    QMutexLocker locker(&headerIndexMutex);
+    const auto cached = headerIndexes.constFind(projectRoot);
+    if (cached != headerIndexes.constEnd()) return cached.value();
+
+    // 广度优先：浅层目录里的同名头文件优先；隐藏目录不列出
+    QHash<QString, QString> index;
+    QQueue<QString> dirs;
+    dirs.enqueue(projectRoot);
+    int visited = 0;
+    while (!dirs.isEmpty() && visited++ < kMaxIndexedDirs && index.size() < kMaxIndexedHeaders) {
+        const QDir dir(dirs.dequeue());
+        const QFileInfoList headers = dir.entryInfoList({"*.h", "*.hh", "*.hpp", "*.hxx"}, QDir::Files);
+        for (const QFileInfo &header : headers) {
+            if (!index.contains(header.fileName())) index.insert(header.fileName(), header.absoluteFilePath());
+        }
+        const QFileInfoList children = dir.entryInfoList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::NoSymLinks);
+        for (const QFileInfo &child : children) {
+            if (!isSkippedDirectory(child.fileName())) dirs.enqueue(child.absoluteFilePath());
+        }
+    }
+    headerIndexes.insert(projectRoot, index);
+    return index;
+}
+
+void ContextBuilder::dropHeaderIndex(const QString &projectRoot)
+{
+    QMutexLocker locker(&headerIndexMutex);
+    headerIndexes.remove(projectRoot);
+}
+
+// ----------------- 候选片段 -----------------
+void ContextBuilder::collect(const SourceFile &file, int depth, int skipStart, int skipEnd,
+                             const QHash<QString, int> &calls, const QSet<QString> &identifiers)
+{
+    const QStringView text(file.text);
+    QVector<QPair<int, int>> functionBodies;
+
+    auto addSnippet = [&](int start, int end, const QString &snippetText, int score) {
+        Snippet snippet;
+        snippet.path = file.path;
+        snippet.start = start;
+        snippet.firstLine = file.lineAt(start);
+        snippet.lastLine = file.lineAt(qMax(start, end - 1));
+        snippet.text = snippetText;
+        snippet.score = score - depth * 10;
+        snippet.tokens = ConversationHistory::estimateTokens(snippetText) + 8;
+        candidates.append(snippet);
+    };
+
+    int functionEnd = -1;   // 函数体内部的块（lambda、if 等）不单独成为片段
+    for (const Block &block : file.blocks) {
+        if (block.open < functionEnd) continue;
+        const QString header = cleanHeader(text.mid(block.headerStart, block.open - block.headerStart));
+        if (isFunctionHeader(header)) {
+            functionEnd = block.close;
+            functionBodies.append({block.open, block.close});
+            if (block.open >= skipStart && block.open < skipEnd) continue;
+            const QString name = declarationName(header);
+            if (calls.contains(name))
+                addSnippet(block.headerStart, block.open, header + ";", 60 + qMin(calls.value(name), 5) * 4);
+            continue;
+        }
+
+        const QString type = typeName(header);
+        if (type.isEmpty() || !identifiers.contains(type)) continue;
+        if (block.headerStart < skipEnd && block.close >= skipStart) continue;   // 包含焦点的类
+        const int start = firstNonSpace(file.text, block.headerStart, block.open);
+        int end = qMin(block.close + 1, file.text.size());
+        if (end < file.text.size() && file.text.at(end) == ';') ++end;
+        addSnippet(start, end, file.text.mid(start, end - start), 45);
+    }
+
+    for (const Statement &statement : file.statements) {
+        const bool inBody = std::any_of(functionBodies.cbegin(), functionBodies.cend(), [&](const QPair<int, int> &body) {
+            return statement.start > body.first && statement.start < body.second;
+        });
+        if (inBody) continue;
+        const QString header = cleanHeader(text.mid(statement.start, statement.end - statement.start));
+        if (!isFunctionHeader(header)) continue;
+        const QString name = declarationName(header);
+        if (calls.contains(name))
+            addSnippet(firstNonSpace(file.text, statement.start, statement.end), statement.end,
+                       header, 55 + qMin(calls.value(name), 5) * 4);
+    }
+
+    if (depth > 0) {
+        const int tokens = ConversationHistory::estimateTokens(file.text);
+        if (tokens <= kWholeFileTokens) {
+            addSnippet(0, file.text.size(), file.text.trimmed(), 15);
+            candidates.last().start = -1;   // 标记为整文件
+        }
+    }
+}
+
+// ----------------- 组装 -----------------
+AiContext ContextBuilder::build(const QString &text, const QString &filePath, int position,
+                                int selectionStart, int selectionEnd, int tokenBudget)
+{
+    candidates.clear();
+
+    SourceFile current;
+    current.path = QFileInfo(filePath).absoluteFilePath();
+    current.text = text;
+    scan(current);
+
+    // 焦点：选区 > 所在函数 > 光标附近的行
+    AiContext context;
+    QString focusName;
+    if (selectionStart < selectionEnd) {
+        context.focusStart = selectionStart;
+        context.focusEnd = selectionEnd;
+    } else {
+        for (const Block &block : current.blocks) {
+            if (position <= block.open || position > block.close) continue;
+            const QString header = cleanHeader(QStringView(text).mid(block.headerStart, block.open - block.headerStart));
+            if (!isFunctionHeader(header)) continue;
+            focusName = declarationName(header);
+            const int start = firstNonSpace(text, block.headerStart, block.open);
+            context.focusStart = current.lineStarts.at(current.lineAt(start) - 1);
+            context.focusEnd = qMin(block.close + 1, text.size());
+            break;
+        }
+
+        const int focusTokens = ConversationHistory::estimateTokens(
+            QStringView(text).mid(context.focusStart, context.focusEnd - context.focusStart));
+        if (focusName.isEmpty() || focusTokens > tokenBudget * 3 / 5) {
+            // 没有所在函数，或函数太长：取光标上下若干行
+            const int line = current.lineAt(position) - 1;
+            const int firstLine = qMax(0, line - kWindowLines);
+            const int lastLine = qMin(int(current.lineStarts.size()) - 1, line + kWindowLines);
+            const int windowStart = current.lineStarts.at(firstLine);
+            const int windowEnd = lastLine + 1 < current.lineStarts.size() ? current.lineStarts.at(lastLine + 1) : text.size();
+            if (focusName.isEmpty()) {
+                context.focusStart = windowStart;
+                context.focusEnd = windowEnd;
+            } else {
+                context.focusStart = qMax(context.focusStart, windowStart);
+                context.focusEnd = qMin(context.focusEnd, windowEnd);
+            }
+        }
+    }
+    // 焦点扩展到整行，回复可以按行替换回去
+    context.focusStart = current.lineStarts.at(current.lineAt(context.focusStart) - 1);
+    const int focusLastLine = current.lineAt(qMax(context.focusStart, context.focusEnd - 1));
+    context.focusEnd = focusLastLine < current.lineStarts.size() ? current.lineStarts.at(focusLastLine) - 1 : text.size();
+    context.focus = text.mid(context.focusStart, context.focusEnd - context.focusStart);
+    const QString lines = QString("第 %1-%2 行").arg(current.lineAt(context.focusStart))
+                              .arg(current.lineAt(qMax(context.focusStart, context.focusEnd - 1)));
+    if (selectionStart < selectionEnd)
+        context.focusLabel = "选中的代码（" + lines + "）";
+    else if (!focusName.isEmpty())
+        context.focusLabel = QString("函数 %1（%2）").arg(focusName, lines);
+    else
+        context.focusLabel = lines;
+
+    // 焦点里调用的函数和出现的标识符
+    QHash<QString, int> calls;
+    QSet<QString> identifiers;
+    static const QRegularExpression call("\\b([A-Za-z_]\\w*)\\s*\\(");
+    static const QRegularExpression word("\\b[A-Za-z_]\\w*\\b");
+    for (QRegularExpressionMatchIterator it = call.globalMatch(context.focus); it.hasNext();) {
+        const QString name = it.next().captured(1);
+        if (!controlKeywords().contains(name) && name != focusName) ++calls[name];
+    }
+    for (QRegularExpressionMatchIterator it = word.globalMatch(context.focus); it.hasNext();)
+        identifiers.insert(it.next().captured());
+
+    // 沿 #include "..." 走两层
+    collect(current, 0, context.focusStart, context.focusEnd, calls, identifiers);
+    QSet<QString> visited = {current.path};
+    QList<QPair<QString, int>> pending;
+    for (const QString &include : std::as_const(current.includes))
+        pending.append(qMakePair(resolveInclude(include, current.path), 1));
+    while (!pending.isEmpty() && visited.size() < kMaxFiles) {
+        const QPair<QString, int> next = pending.takeFirst();
+        if (next.first.isEmpty() || visited.contains(next.first)) continue;
+        visited.insert(next.first);
+
+        SourceFile file;
+        file.path = next.first;
+        file.text = readFile(file.path);
+        if (file.text.isEmpty()) continue;
+        scan(file);
+        collect(file, next.second, -1, -1, calls, identifiers);
+        if (next.second < 2) {
+            for (const QString &include : std::as_const(file.includes))
+                pending.append(qMakePair(resolveInclude(include, file.path), next.second + 1));
+        }
+    }
+
+    // 同名签名（头文件声明与 .cpp 定义）只保留得分最高的两条
+    std::stable_sort(candidates.begin(), candidates.end(), [](const Snippet &a, const Snippet &b) {
+        return a.score != b.score ? a.score > b.score : a.tokens < b.tokens;
+    });
+    QHash<QString, int> seen;
+    QList<Snippet> chosen;
+    QSet<QString> wholeFiles;
+    const int focusTokens = ConversationHistory::estimateTokens(context.focus);
+    int remaining = tokenBudget - focusTokens;
+    for (const Snippet &snippet : std::as_const(candidates)) {
+        if (snippet.tokens > remaining || wholeFiles.contains(snippet.path)) continue;
+        if (snippet.start >= 0 && ++seen[snippet.text.simplified()] > 2) continue;
+        if (snippet.start < 0) {
+            // 整个文件：替换掉已选的同文件片段
+            for (int i = chosen.size() - 1; i >= 0; --i) {
+                if (chosen.at(i).path != snippet.path) continue;
+                remaining += chosen.at(i).tokens;
+                chosen.removeAt(i);
+            }
+            wholeFiles.insert(snippet.path);
+        }
+        chosen.append(snippet);
+        remaining -= snippet.tokens;
+    }
+
+    // 输出按文件、行号排序，当前文件在前
+    std::sort(chosen.begin(), chosen.end(), [&](const Snippet &a, const Snippet &b) {
+        const bool aCurrent = a.path == current.path;
+        const bool bCurrent = b.path == current.path;
+        if (aCurrent != bCurrent) return aCurrent;
+        return a.path != b.path ? a.path < b.path : a.start < b.start;
+    });
+    const QDir base(root.isEmpty() ? QFileInfo(current.path).absolutePath() : root);
+    QStringList sections;
+    for (const Snippet &snippet : std::as_const(chosen)) {
+        QString location = base.relativeFilePath(snippet.path);
+        if (snippet.start >= 0) {
+            location += ":" + QString::number(snippet.firstLine);
+            if (snippet.lastLine > snippet.firstLine) location += "-" + QString::number(snippet.lastLine);
+        }
+        sections.append("// " + location + "\n" + snippet.text);
+    }
+    context.reference = sections.join("\n\n");
+    context.tokens = tokenBudget - remaining;
+    return context;
+}
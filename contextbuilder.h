@@ -0,0 +1,98 @@
+#ifndef CONTEXTBUILDER_H
+#define CONTEXTBUILDER_H
+
+#include <QHash>
+#include <QList>
+#include <QSet>
+#include <QString>
+#include <QVector>
+
+// 发给 AI 的代码上下文
+struct AiContext
+{
+    int focusStart = 0;          // 要处理的代码在当前文档中的范围（整行，不含末尾换行）
+    int focusEnd = 0;
+    QString focus;
+    QString focusLabel;          // “函数 foo” / “第 a-b 行”
+    QString reference;           // 按相关度挑出的只读参考片段，可能为空
+    int tokens = 0;              // focus + reference 的估算 token 数
+};
+
+// ----------------------------------------------------------------------
+// ContextBuilder：按相关度挑选代码片段，装进 token 预算
+// 以光标所在函数（或选区）为中心，沿两条边找相关代码：
+//   - 函数里调用到的函数 → 当前文件和被包含头文件中的声明（只取签名）
+//   - 函数里用到的类型 → 这些文件中 class/struct/enum 的定义
+//   - #include "..." 的项目头文件（两层以内），较小的整体附上
+// 片段按得分从高到低装入预算，输出时再按文件和行号排序。
+// 只做词法扫描（跳过注释、字符串和预处理行后匹配花括号），不依赖编译器或 clangd。
+// 会读磁盘文件，应放在工作线程里调用 build()。
+class ContextBuilder
+{
+public:
+    // openBuffers：已在编辑器中打开的文件（路径 → 未保存的文本），优先于磁盘内容
+    ContextBuilder(const QString &projectRoot, const QHash<QString, QString> &openBuffers = {});
+
+    // selectionStart < selectionEnd 时以选区为中心，否则以 position 所在函数为中心
+    AiContext build(const QString &text, const QString &filePath, int position,
+                    int selectionStart, int selectionEnd, int tokenBudget);
+
+    // 项目头文件索引按根目录缓存；切换或重新载入项目时丢弃
+    static void dropHeaderIndex(const QString &projectRoot);
+
+private:
+    struct Block
+    {
+        int headerStart = 0;     // 花括号前语句的起点
+        int open = 0;
+        int close = 0;
+        int depth = 0;
+    };
+
+    struct Statement             // 以 ';' 结尾的语句
+    {
+        int start = 0;
+        int end = 0;
+        int depth = 0;
+    };
+
+    struct SourceFile
+    {
+        QString path;
+        QString text;
+        QVector<Block> blocks;
+        QVector<Statement> statements;
+        QVector<int> lineStarts;
+        QStringList includes;    // #include "..." 的原文
+        int lineAt(int position) const;
+    };
+
+    struct Snippet
+    {
+        QString path;
+        int start = 0;
+        int firstLine = 0;
+        int lastLine = 0;
+        QString text;
+        int score = 0;
+        int tokens = 0;
+    };
+
+    static void scan(SourceFile &file);
+    static QString declarationName(QStringView header);       // “A::foo(” 中的 foo
+    static bool isFunctionHeader(QStringView header);
+    static QString typeName(QStringView header);               // class/struct/enum 名
+    static QHash<QString, QString> headerIndex(const QString &projectRoot);   // 文件名 → 路径
+    QString resolveInclude(const QString &include, const QString &fromPath);
+    QString readFile(const QString &path) const;
+    void collect(const SourceFile &file, int depth, int skipStart, int skipEnd,
+                 const QHash<QString, int> &calls, const QSet<QString> &identifiers);
+
+    QString root;
+    QHash<QString, QString> buffers;
+    QHash<QString, QString> projectHeaders;   // 首次需要时从 headerIndex() 取得
+    bool headersIndexed = false;
+    QList<Snippet> candidates;
+};
+
+#endif // CONTEXTBUILDER_H
@@ -0,0 +1,128 @@
+#include "conversationhistory.h"
+
+#include <QJsonObject>
+
+namespace {
+const int kMessageOverhead = 4;     // 每条消息的角色、分隔符
+const int kSummaryLineLength = 80;
+}
+
+int ConversationHistory::estimateTokens(QStringView text)
+{
+    int ascii = 0;
+    int other = 0;
+    for (QChar ch : text) {
+        if (ch.unicode() < 0x80) ++ascii;
+        else if (!ch.isLowSurrogate()) ++other;
+    }
+    return (ascii + 3) / 4 + other;
+}
+
+void ConversationHistory::addUser(const QString &text)
+{
+    Turn turn;
+    turn.id = nextId++;
+    turn.role = "user";
+    turn.content = text;
+    turn.tokens = estimateTokens(text) + kMessageOverhead;
+    totalTokens += turn.tokens;
+    turns.append(turn);
+    compact();
+}
+
+int ConversationHistory::beginReply()
+{
+    Turn turn;
+    turn.id = nextId++;
+    turn.role = "assistant";
+    turn.tokens = kMessageOverhead;
+    totalTokens += turn.tokens;
+    turns.append(turn);
+    return turn.id;
+}
+
+void ConversationHistory::appendReply(int id, const QString &delta)
+{
+    const int index = indexOf(id);
+    if (index < 0) return;   // 已被压缩掉
+    Turn &turn = turns[index];
+    turn.content += delta;
+    const int tokens = estimateTokens(delta);
+    turn.tokens += tokens;
+    totalTokens += tokens;
+}
+
+void ConversationHistory::finishReply(int id)
+{
+    const int index = indexOf(id);
+    if (index < 0) return;
+
+    if (turns.at(index).content.isEmpty()) {
+        // 请求失败或被取消：这轮问答不进入后续上下文
+        totalTokens -= turns.at(index).tokens;
+        turns.removeAt(index);
+        if (index > 0 && turns.at(index - 1).role == "user") {
+            totalTokens -= turns.at(index - 1).tokens;
+            turns.removeAt(index - 1);
+        }
+        return;
+    }
+    compact();
+}
+
+QJsonArray ConversationHistory::messages() const
+{
+    QJsonArray result;
+    if (!summaryLines.isEmpty()) {
+        result.append(QJsonObject{
+            {"role", "system"},
+            {"content", "早先对话中用户问过（已压缩）：\n" + summaryLines.join('\n')}
+        });
+    }
+    for (const Turn &turn : turns) {
+        if (turn.content.isEmpty()) continue;   // 仍在等待的回复
+        result.append(QJsonObject{{"role", turn.role}, {"content", turn.content}});
+    }
+    return result;
+}
+
+void ConversationHistory::clear()
+{
+    turns.clear();
+    summaryLines.clear();
+    summaryTokens = 0;
+    totalTokens = 0;
+}
+
+int ConversationHistory::indexOf(int id) const
+{
+    // 几乎总是最后一轮，从后往前找
+    for (int i = turns.size() - 1; i >= 0; --i) {
+        if (turns.at(i).id == id) return i;
+    }
+    return -1;
+}
+
+void ConversationHistory::compact()
+{
+    // 最新的一轮总是保留，哪怕它本身就超出预算
+    while (totalTokens + summaryTokens > tokenBudget && turns.size() > 1) {
+        const Turn turn = turns.takeFirst();
+        totalTokens -= turn.tokens;
+        if (turn.role != "user") continue;
+
+        QString line = turn.content.section('\n', 0, 0).simplified();
+        if (line.size() > kSummaryLineLength)
+            line = line.left(kSummaryLineLength) + "…";
+        line = "- " + line;
+        summaryLines.append(line);
+        summaryTokens += estimateTokens(line) + 1;
+    }
+
+    // 摘要本身最多占预算的五分之一，超出时丢掉最早的要点
+    while (summaryTokens > tokenBudget / 5 && !summaryLines.isEmpty()) {
+        summaryTokens -= estimateTokens(summaryLines.first()) + 1;
+        summaryLines.removeFirst();
+    }
+    if (summaryLines.isEmpty()) summaryTokens = 0;
+}
@@ -0,0 +1,56 @@
+#ifndef CONVERSATIONHISTORY_H
+#define CONVERSATIONHISTORY_H
+
+#include <QJsonArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+// ----------------------------------------------------------------------
+// ConversationHistory：按 token 预算保存的多轮对话
+// 每轮记录角色、正文和估算的 token 数。流式回复直接追加到该轮的 QString 上，
+// 不再每个 delta 复制一次 JSON 对象。总量超出预算时，最早的几轮从队首移除，
+// 其中的用户提问压缩成一行要点放进摘要，请求体大小因此有上限。
+class ConversationHistory
+{
+public:
+    void setBudget(int tokens) { tokenBudget = qMax(256, tokens); compact(); }
+    int budget() const { return tokenBudget; }
+    int tokenCount() const { return totalTokens + summaryTokens; }
+
+    void addUser(const QString &text);
+
+    // 开始一轮助手回复，返回其编号；回复结束后调用 finishReply
+    int beginReply();
+    void appendReply(int id, const QString &delta);
+    void finishReply(int id);   // 空回复连同对应的提问一起丢弃
+
+    // 摘要（如有）+ 保留的各轮，可直接拼在系统提示词之后
+    QJsonArray messages() const;
+
+    void clear();
+
+    // 粗略估算：ASCII 约 4 字符一个 token，其余（中文等）约 1 字符一个
+    static int estimateTokens(QStringView text);
+
+private:
+    struct Turn
+    {
+        int id = 0;
+        QString role;
+        QString content;
+        int tokens = 0;
+    };
+
+    int indexOf(int id) const;
+    void compact();
+
+    QList<Turn> turns;           // 从队首移除是 O(1)
+    QStringList summaryLines;    // 被移出的提问要点
+    int summaryTokens = 0;
+    int totalTokens = 0;
+    int tokenBudget = 4000;
+    int nextId = 1;
+};
+
+#endif // CONVERSATIONHISTORY_H
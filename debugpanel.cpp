@@ -0,0 +1,256 @@
+#include "debugpanel.h"
+
+#include <QAction>
+#include <QHeaderView>
+#include <QLineEdit>
+#include <QTabWidget>
+#include <QTreeWidget>
+#include <QVBoxLayout>
+
+namespace {
+const int kPageSize = 100;                  // 每次取的子项数
+const int IdRole = Qt::UserRole;            // 变量对象 id
+const int LoadedRole = Qt::UserRole + 1;    // 子项已开始加载
+const int MoreRole = Qt::UserRole + 2;      // “加载更多”行：下一页的起点
+}
+
+DebugPanel::DebugPanel(DebugSession *session, QWidget *parent)
+    : QWidget(parent)
+    , session(session)
+{
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->setContentsMargins(4, 4, 4, 4);
+
+    QTabWidget *tabs = new QTabWidget(this);
+    localsTree = createTree();
+    tabs->addTab(localsTree, "局部变量");
+
+    QWidget *watchPage = new QWidget(tabs);
+    QVBoxLayout *watchLayout = new QVBoxLayout(watchPage);
+    watchLayout->setContentsMargins(0, 0, 0, 0);
+    watchInput = new QLineEdit(watchPage);
+    watchInput->setPlaceholderText("添加监视表达式，回车确认");
+    watchTree = createTree();
+    watchLayout->addWidget(watchInput);
+    watchLayout->addWidget(watchTree);
+    tabs->addTab(watchPage, "监视");
+    layout->addWidget(tabs);
+
+    QAction *removeAction = new QAction("删除监视", watchTree);
+    removeAction->setShortcut(QKeySequence::Delete);
+    removeAction->setShortcutContext(Qt::WidgetShortcut);
+    watchTree->setContextMenuPolicy(Qt::ActionsContextMenu);
+    watchTree->addAction(removeAction);
+    connect(removeAction, &QAction::triggered, this, &DebugPanel::removeCurrentWatch);
+    connect(watchInput, &QLineEdit::returnPressed, this, &DebugPanel::addWatch);
+
+    connect(session, &DebugSession::stateChanged, this, &DebugPanel::onStateChanged);
+    connect(session, &DebugSession::stopped, this, &DebugPanel::clearHighlights);
+    connect(session, &DebugSession::localsChanged, this, &DebugPanel::onLocalsChanged);
+    connect(session, &DebugSession::variablesUpdated, this, &DebugPanel::onVariablesUpdated);
+    connect(session, &DebugSession::watchReady, this, &DebugPanel::onWatchReady);
+    connect(session, &DebugSession::childrenReady, this, &DebugPanel::onChildrenReady);
+}
+
+QTreeWidget *DebugPanel::createTree()
+{
+    QTreeWidget *tree = new QTreeWidget(this);
+    tree->setColumnCount(3);
+    tree->setHeaderLabels({"名称", "值", "类型"});
+    tree->header()->setSectionResizeMode(0, QHeaderView::Interactive);
+    tree->setUniformRowHeights(true);   // 大容器展开后滚动不必逐行测量
+    connect(tree, &QTreeWidget::itemExpanded, this, &DebugPanel::onItemExpanded);
+    connect(tree, &QTreeWidget::itemClicked, this, &DebugPanel::onItemClicked);
+    return tree;
+}
+
+// ----------------- 会话状态 -----------------
+void DebugPanel::onStateChanged(DebugSession::State state)
+{
+    if (state != DebugSession::Idle) return;
+
+    // 会话结束：局部变量清空，监视表达式保留到下次
+    clearHighlights();
+    for (int i = 0; i < localsTree->topLevelItemCount(); ++i)
+        forget(localsTree->topLevelItem(i));
+    localsTree->clear();
+    for (int i = 0; i < watchTree->topLevelItemCount(); ++i) {
+        QTreeWidgetItem *item = watchTree->topLevelItem(i);
+        clearChildren(item);
+        items.remove(item->data(0, IdRole).toString());
+        item->setData(0, IdRole, QString());
+        item->setText(1, QString());
+        item->setChildIndicatorPolicy(QTreeWidgetItem::DontShowIndicator);
+    }
+}
+
+void DebugPanel::onLocalsChanged(const QList<DebugVariable> &locals)
+{
+    for (int i = 0; i < localsTree->topLevelItemCount(); ++i)
+        forget(localsTree->topLevelItem(i));
+    localsTree->clear();
+
+    QList<QTreeWidgetItem*> rows;
+    rows.reserve(locals.size());
+    for (const DebugVariable &variable : locals) {
+        QTreeWidgetItem *item = new QTreeWidgetItem;
+        fill(item, variable);
+        rows.append(item);
+    }
+    localsTree->addTopLevelItems(rows);
+}
+
+void DebugPanel::onWatchReady(const QString &expression, const DebugVariable &variable)
+{
+    QTreeWidgetItem *item = nullptr;
+    for (int i = 0; i < watchTree->topLevelItemCount() && !item; ++i) {
+        if (watchTree->topLevelItem(i)->text(0) == expression)
+            item = watchTree->topLevelItem(i);
+    }
+    if (!item) item = new QTreeWidgetItem(watchTree);
+
+    clearChildren(item);
+    items.remove(item->data(0, IdRole).toString());
+    fill(item, variable);
+}
+
+void DebugPanel::onVariablesUpdated(const QList<DebugVariable> &changes)
+{
+    for (const DebugVariable &change : changes) {
+        QTreeWidgetItem *item = items.value(change.id);
+        if (!item) continue;   // 尚未展开的子项
+
+        if (!change.inScope) {
+            item->setText(1, "<不在作用域>");
+            item->setForeground(1, palette().brush(QPalette::Disabled, QPalette::Text));
+            continue;
+        }
+        item->setText(1, change.value);
+        item->setForeground(1, QColor(200, 30, 30));
+        changedItems.append(item);
+        if (!change.type.isEmpty()) item->setText(2, change.type);
+
+        if (change.childrenChanged) {
+            // 已取的子项作废，下次展开时重新取
+            const bool expanded = item->isExpanded();
+            clearChildren(item);
+            item->setData(0, LoadedRole, false);
+            const bool expandable = change.childCount > 0 || change.hasMore
+                                    || (change.childCount < 0 && item->childIndicatorPolicy() == QTreeWidgetItem::ShowIndicator);
+            item->setChildIndicatorPolicy(expandable ? QTreeWidgetItem::ShowIndicator
+                                                     : QTreeWidgetItem::DontShowIndicator);
+            if (expanded && expandable) onItemExpanded(item);
+        }
+    }
+}
+
+void DebugPanel::clearHighlights()
+{
+    for (QTreeWidgetItem *item : std::as_const(changedItems))
+        item->setData(1, Qt::ForegroundRole, QVariant());
+    changedItems.clear();
+}
+
+// ----------------- 子项分页 -----------------
+void DebugPanel::onItemExpanded(QTreeWidgetItem *item)
+{
+    const QString id = item->data(0, IdRole).toString();
+    if (id.isEmpty() || item->data(0, LoadedRole).toBool()) return;
+    item->setData(0, LoadedRole, true);
+    session->listChildren(id, 0, kPageSize);
+}
+
+void DebugPanel::onItemClicked(QTreeWidgetItem *item)
+{
+    const QVariant next = item->data(0, MoreRole);
+    if (!next.isValid() || !item->parent()) return;
+    const QString id = item->parent()->data(0, IdRole).toString();
+    item->setText(0, "正在加载…");
+    item->setData(0, MoreRole, QVariant());   // 回复前不重复请求
+    session->listChildren(id, next.toInt(), kPageSize);
+}
+
+void DebugPanel::onChildrenReady(const QString &id, int from, const QList<DebugVariable> &children, bool hasMore)
+{
+    QTreeWidgetItem *parent = items.value(id);
+    if (!parent) return;
+
+    // 去掉上一页留下的“加载更多”行
+    if (parent->childCount() > 0) {
+        QTreeWidgetItem *last = parent->child(parent->childCount() - 1);
+        if (last->data(0, IdRole).toString().isEmpty())
+            delete parent->takeChild(parent->childCount() - 1);
+    }
+    if (parent->childCount() != from) return;   // 子项已作废，这一页过期了
+
+    QList<QTreeWidgetItem*> rows;
+    rows.reserve(children.size() + 1);
+    for (const DebugVariable &child : children) {
+        QTreeWidgetItem *item = new QTreeWidgetItem;
+        fill(item, child);
+        rows.append(item);
+    }
+    if (hasMore) {
+        QTreeWidgetItem *more = new QTreeWidgetItem;
+        more->setText(0, QString("… 加载更多（已显示 %1 项）").arg(from + children.size()));
+        more->setData(0, MoreRole, from + children.size());
+        more->setForeground(0, palette().brush(QPalette::Link));
+        rows.append(more);
+    }
+    parent->addChildren(rows);
+}
+
+// ----------------- 行 -----------------
+void DebugPanel::fill(QTreeWidgetItem *item, const DebugVariable &variable)
+{
+    item->setText(0, variable.expression);
+    item->setText(1, variable.value);
+    item->setText(2, variable.type);
+    item->setData(0, IdRole, variable.id);
+    item->setData(0, LoadedRole, false);
+    item->setToolTip(1, variable.value);
+    item->setChildIndicatorPolicy(variable.isExpandable() ? QTreeWidgetItem::ShowIndicator
+                                                          : QTreeWidgetItem::DontShowIndicator);
+    if (!variable.id.isEmpty()) items.insert(variable.id, item);
+}
+
+void DebugPanel::forget(QTreeWidgetItem *item)
+{
+    changedItems.removeAll(item);
+    items.remove(item->data(0, IdRole).toString());
+    for (int i = 0; i < item->childCount(); ++i)
+        forget(item->child(i));
+}
+
+void DebugPanel::clearChildren(QTreeWidgetItem *item)
+{
+    const QList<QTreeWidgetItem*> children = item->takeChildren();
+    for (QTreeWidgetItem *child : children) {
+        forget(child);
+        delete child;
+    }
+}
+
+// ----------------- 监视 -----------------
+void DebugPanel::addWatch()
+{
+    const QString expression = watchInput->text().trimmed();
+    if (expression.isEmpty()) return;
+    watchInput->clear();
+    if (session->watches().contains(expression)) return;
+
+    QTreeWidgetItem *item = new QTreeWidgetItem(watchTree);
+    item->setText(0, expression);
+    session->addWatch(expression);
+}
+
+void DebugPanel::removeCurrentWatch()
+{
+    QTreeWidgetItem *item = watchTree->currentItem();
+    while (item && item->parent()) item = item->parent();
+    if (!item) return;
+
+    session->removeWatch(item->text(0));
+    forget(item);
+    delete item;
+}
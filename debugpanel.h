@@ -0,0 +1,49 @@
+#ifndef DEBUGPANEL_H
+#define DEBUGPANEL_H
+
+#include <QWidget>
+#include <QHash>
+#include <QList>
+#include "debugsession.h"
+
+class QLineEdit;
+class QTreeWidget;
+class QTreeWidgetItem;
+
+// ----------------------------------------------------------------------
+// DebugPanel：调试时的“局部变量 / 监视”视图
+// 子项在第一次展开时才向 gdb 要，每次一页；容器超过一页时末尾留一行
+// “加载更多”，点了再取下一页。单步后只刷新值变了的行，并标红。
+class DebugPanel : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit DebugPanel(DebugSession *session, QWidget *parent = nullptr);
+
+private slots:
+    void onStateChanged(DebugSession::State state);
+    void onLocalsChanged(const QList<DebugVariable> &locals);
+    void onVariablesUpdated(const QList<DebugVariable> &changes);
+    void onWatchReady(const QString &expression, const DebugVariable &variable);
+    void onChildrenReady(const QString &id, int from, const QList<DebugVariable> &children, bool hasMore);
+    void onItemExpanded(QTreeWidgetItem *item);
+    void onItemClicked(QTreeWidgetItem *item);
+    void addWatch();
+    void removeCurrentWatch();
+
+private:
+    QTreeWidget *createTree();
+    void fill(QTreeWidgetItem *item, const DebugVariable &variable);
+    void forget(QTreeWidgetItem *item);          // 从 id 索引中移除 item 及其子项
+    void clearChildren(QTreeWidgetItem *item);
+    void clearHighlights();
+
+    DebugSession *session;
+    QTreeWidget *localsTree;
+    QTreeWidget *watchTree;
+    QLineEdit *watchInput;
+    QHash<QString, QTreeWidgetItem*> items;      // 变量对象 id → 行
+    QList<QTreeWidgetItem*> changedItems;        // 上次停下后值变了的行
+};
+
+#endif // DEBUGPANEL_H
@@ -0,0 +1,427 @@
+#include "debugsession.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QStandardPaths>
+#include <QTimer>
+
+#include <memory>
+
+DebugSession::DebugSession(QObject *parent)
+    : QObject(parent)
+{
+}
+
+DebugSession::~DebugSession()
+{
+    stop();
+}
+
+// ----------------- 调试器进程 -----------------
+QString DebugSession::findDebugger()
+{
+    // 与编译器、clangd 一样，优先使用随 IDE 附带的
+    const QString bundled = QDir(QCoreApplication::applicationDirPath()).filePath("mingw/bin");
+    QString path = QStandardPaths::findExecutable("gdb", {bundled});
+    if (path.isEmpty())
+        path = QStandardPaths::findExecutable("gdb");
+    return path;
+}
+
+bool DebugSession::start(const QString &program, const QString &workingDir,
+                         const QMultiHash<QString, int> &initialBreakpoints)
+{
+    if (isActive()) return false;
+
+    const QString debugger = findDebugger();
+    if (debugger.isEmpty()) return false;
+
+    readBuffer.clear();
+    handlers.clear();
+    breakpoints.clear();
+    localsFrame.clear();
+    localNames.clear();
+    localIds.clear();
+    watchIds.clear();
+
+    process = new QProcess(this);
+    process->setProgram(debugger);
+    process->setArguments({"--interpreter=mi", "--nx", "--quiet"});
+    process->setWorkingDirectory(workingDir);
+    process->setProcessChannelMode(QProcess::MergedChannels);
+    connect(process, &QProcess::readyReadStandardOutput, this, &DebugSession::onReadyRead);
+    connect(process, &QProcess::finished, this, &DebugSession::onFinished);
+    connect(process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error != QProcess::FailedToStart) return;   // 启动失败时不会有 finished
+        emit output("❌ 无法启动 gdb：" + process->errorString());
+        onFinished();
+    });
+    connect(process, &QProcess::started, this, [this, program, workingDir, initialBreakpoints]() {
+        sendStartupCommands(program, workingDir, initialBreakpoints);
+    });
+
+    // 不等进程就绪：started 之后再发命令，启动失败由 errorOccurred 收尾
+    setState(Starting);
+    process->start();
+    return true;
+}
+
+void DebugSession::sendStartupCommands(const QString &program, const QString &workingDir,
+                                       const QMultiHash<QString, int> &initialBreakpoints)
+{
+    // 异步模式下程序运行时仍可接收命令（中断、设断点）
+    send("-gdb-set mi-async on");
+    send("-enable-pretty-printing");
+#ifdef Q_OS_WIN
+    send("-gdb-set new-console on");   // 程序有自己的控制台窗口，与“运行”一致
+#endif
+    send("-file-exec-and-symbols " + GdbMiRecord::quote(QDir::fromNativeSeparators(program)),
+         [this](const GdbMiRecord &record) {
+        if (record.resultClass == "error") {
+            emit output("❌ 无法载入程序：" + record.results["msg"].text());
+            stop();
+        }
+    });
+    send("-environment-cd " + GdbMiRecord::quote(QDir::fromNativeSeparators(workingDir)));
+    for (auto it = initialBreakpoints.cbegin(); it != initialBreakpoints.cend(); ++it)
+        insertBreakpoint(it.key(), it.value());
+    execute("-exec-run");
+}
+
+void DebugSession::stop()
+{
+    if (!process) return;
+
+    // 不等 gdb 退出：请它自行退出，过一会儿仍在运行就强制结束；会话立即回到空闲
+    QProcess *old = process;
+    process = nullptr;
+    old->disconnect(this);
+    if (old->state() == QProcess::NotRunning) {
+        old->deleteLater();
+    } else {
+        connect(old, &QProcess::finished, old, &QObject::deleteLater);
+        old->write("-gdb-exit\n");
+        QTimer::singleShot(500, old, [old]() {
+            if (old->state() != QProcess::NotRunning) old->kill();
+        });
+    }
+    onFinished();
+}
+
+void DebugSession::onFinished()
+{
+    handlers.clear();
+    breakpoints.clear();
+    localIds.clear();
+    localNames.clear();
+    localsFrame.clear();
+    watchIds.clear();
+    if (process) {
+        process->deleteLater();
+        process = nullptr;
+    }
+    setState(Idle);
+}
+
+void DebugSession::setState(State state)
+{
+    if (current == state) return;
+    current = state;
+    emit stateChanged(state);
+}
+
+// ----------------- 命令 -----------------
+void DebugSession::send(const QByteArray &command, const Handler &handler)
+{
+    if (!process) return;
+    const int token = nextToken++;
+    if (handler) handlers.insert(token, handler);
+    process->write(QByteArray::number(token) + command + '\n');
+}
+
+void DebugSession::execute(const QByteArray &command)
+{
+    // 运行类命令：回复 ^running 之前就不再接受新的单步，按住快捷键也不会堆积
+    if (current == Running) return;
+    const bool launching = current == Starting;
+    setState(Running);
+    send(command, [this, launching](const GdbMiRecord &record) {
+        if (record.resultClass != "error") return;
+        emit output("❌ " + record.results["msg"].text());
+        if (launching)
+            stop();
+        else
+            setState(Stopped);
+    });
+}
+
+void DebugSession::continueRun()
+{
+    if (current == Stopped) execute("-exec-continue");
+}
+
+void DebugSession::stepOver()
+{
+    if (current == Stopped) execute("-exec-next");
+}
+
+void DebugSession::stepInto()
+{
+    if (current == Stopped) execute("-exec-step");
+}
+
+void DebugSession::stepOut()
+{
+    if (current == Stopped) execute("-exec-finish");
+}
+
+void DebugSession::interrupt()
+{
+    if (current == Running) send("-exec-interrupt");
+}
+
+// ----------------- 断点 -----------------
+QString DebugSession::breakpointKey(const QString &file, int line)
+{
+    return QDir::cleanPath(QDir::fromNativeSeparators(file)) + ':' + QString::number(line);
+}
+
+void DebugSession::insertBreakpoint(const QString &file, int line)
+{
+    const QString key = breakpointKey(file, line);
+    if (!process || breakpoints.contains(key)) return;
+    breakpoints.insert(key, 0);   // 占位，回复前重复点击不会再插一次
+
+    // -f：源文件属于尚未载入的共享库时先挂起，载入后生效
+    send("-break-insert -f --source " + GdbMiRecord::quote(QDir::fromNativeSeparators(file))
+             + " --line " + QByteArray::number(line),
+         [this, key](const GdbMiRecord &record) {
+        if (record.resultClass == "error") {
+            breakpoints.remove(key);
+            emit output("⚠️ 断点设置失败：" + record.results["msg"].text());
+            return;
+        }
+        const int number = record.results["bkpt"]["number"].toInt();
+        if (breakpoints.contains(key)) {
+            breakpoints.insert(key, number);
+        } else {
+            // 回复到达前已被取消
+            send("-break-delete " + QByteArray::number(number));
+        }
+    });
+}
+
+void DebugSession::removeBreakpoint(const QString &file, int line)
+{
+    const QString key = breakpointKey(file, line);
+    if (!breakpoints.contains(key)) return;
+    const int number = breakpoints.take(key);
+    if (number > 0) send("-break-delete " + QByteArray::number(number));
+}
+
+// ----------------- 输出解析 -----------------
+void DebugSession::onReadyRead()
+{
+    readBuffer += process->readAllStandardOutput();
+    int start = 0;
+    int newline;
+    while ((newline = readBuffer.indexOf('\n', start)) >= 0) {
+        const QByteArray line = readBuffer.mid(start, newline - start);
+        start = newline + 1;
+
+        const GdbMiRecord record = GdbMiRecord::parse(line);
+        if (record.type == GdbMiRecord::Invalid) {
+            // 被调试程序与 gdb 共用终端时，它的输出原样混在其中
+            const QString text = QString::fromLocal8Bit(line).trimmed();
+            if (!text.isEmpty()) emit output(text);
+            continue;
+        }
+        handleRecord(record);
+        if (!process) return;   // 回调中结束了会话
+    }
+    readBuffer.remove(0, start);
+}
+
+void DebugSession::handleRecord(const GdbMiRecord &record)
+{
+    switch (record.type) {
+    case GdbMiRecord::Result: {
+        const Handler handler = handlers.take(record.token);
+        if (handler)
+            handler(record);
+        else if (record.resultClass == "error")
+            emit output("⚠️ " + record.results["msg"].text());
+        break;
+    }
+    case GdbMiRecord::Exec:
+        if (record.resultClass == "running")
+            setState(Running);
+        else if (record.resultClass == "stopped")
+            handleStopped(record.results);
+        break;
+    case GdbMiRecord::Console:
+    case GdbMiRecord::Target:
+        if (!record.stream.trimmed().isEmpty())
+            emit output(record.stream.trimmed());
+        break;
+    default:
+        break;
+    }
+}
+
+void DebugSession::handleStopped(const GdbMiValue &results)
+{
+    const QString reason = results["reason"].text();
+    if (reason.startsWith("exited")) {
+        // exit-code 以八进制给出
+        bool ok = false;
+        const int code = results["exit-code"].text().toInt(&ok, 8);
+        emit exited(ok ? code : 0);
+        stop();
+        return;
+    }
+
+    setState(Stopped);
+    const GdbMiValue &frame = results["frame"];
+    QString description = reason;
+    if (reason == "signal-received")
+        description = results["signal-name"].text() + " " + results["signal-meaning"].text();
+
+    const QString file = frame["fullname"].text();
+    emit stopped(file, frame["line"].toInt(), frame["func"].text(), description);
+    refreshVariables(frame["func"].text() + '@' + file);
+}
+
+// ----------------- 变量 -----------------
+DebugVariable DebugSession::variableFrom(const GdbMiValue &value)
+{
+    DebugVariable variable;
+    variable.id = value["name"].text();
+    variable.expression = value["exp"].text();
+    variable.value = value["value"].text();
+    variable.type = value["type"].text();
+    variable.childCount = value["numchild"].toInt();
+    variable.hasMore = value["has_more"].toInt() != 0;
+    return variable;
+}
+
+void DebugSession::refreshVariables(const QString &frameKey)
+{
+    send("-stack-list-variables --no-values", [this, frameKey](const GdbMiRecord &record) {
+        QStringList names;
+        for (const GdbMiValue &item : record.results["variables"].children())
+            names.append(item["name"].text());
+
+        // 同一函数内单步：变量对象还在，只取变化
+        if (frameKey != localsFrame || names != localNames)
+            rebuildLocals(frameKey, names);
+        updateVariables();
+        for (const QString &expression : std::as_const(watchExpressions)) {
+            if (!watchIds.contains(expression)) createWatch(expression);
+        }
+    });
+}
+
+void DebugSession::rebuildLocals(const QString &frameKey, const QStringList &names)
+{
+    for (const QString &id : std::as_const(localIds))
+        send("-var-delete " + id.toUtf8());
+    localIds.clear();
+    localsFrame = frameKey;
+    localNames = names;
+
+    if (names.isEmpty()) {
+        emit localsChanged({});
+        return;
+    }
+
+    // 回复按发出顺序到达，最后一个回来时整体交给界面
+    auto locals = std::make_shared<QList<DebugVariable>>();
+    for (int i = 0; i < names.size(); ++i) {
+        const QString name = names.at(i);
+        const bool last = i == names.size() - 1;
+        send("-var-create - * " + GdbMiRecord::quote(name), [this, locals, name, last](const GdbMiRecord &record) {
+            DebugVariable variable;
+            if (record.resultClass == "error") {
+                variable.value = record.results["msg"].text();
+            } else {
+                variable = variableFrom(record.results);
+                localIds.append(variable.id);
+            }
+            variable.expression = name;
+            locals->append(variable);
+            if (last) emit localsChanged(*locals);
+        });
+    }
+}
+
+void DebugSession::updateVariables()
+{
+    send("-var-update --all-values *", [this](const GdbMiRecord &record) {
+        QList<DebugVariable> changes;
+        for (const GdbMiValue &item : record.results["changelist"].children()) {
+            DebugVariable variable;
+            variable.id = item["name"].text();
+            variable.value = item["value"].text();
+            variable.inScope = item["in_scope"].text() == "true";
+            variable.type = item["new_type"].text();
+            variable.hasMore = item["has_more"].toInt() != 0;
+            variable.childCount = item["new_num_children"].toInt(-1);
+            variable.childrenChanged = item["type_changed"].text() == "true"
+                                       || item["new_num_children"].isValid()
+                                       || item["new_children"].isValid();
+            changes.append(variable);
+        }
+        if (!changes.isEmpty()) emit variablesUpdated(changes);
+    });
+}
+
+void DebugSession::listChildren(const QString &id, int from, int count)
+{
+    if (current != Stopped) return;
+    send("-var-list-children --all-values " + id.toUtf8() + ' ' + QByteArray::number(from) + ' '
+             + QByteArray::number(from + count),
+         [this, id, from](const GdbMiRecord &record) {
+        QList<DebugVariable> children;
+        for (const GdbMiValue &item : record.results["children"].children())
+            children.append(variableFrom(item));
+        emit childrenReady(id, from, children, record.results["has_more"].toInt() != 0);
+    });
+}
+
+void DebugSession::addWatch(const QString &expression)
+{
+    if (expression.trimmed().isEmpty() || watchExpressions.contains(expression)) return;
+    watchExpressions.append(expression);
+    if (current == Stopped) createWatch(expression);
+}
+
+void DebugSession::removeWatch(const QString &expression)
+{
+    watchExpressions.removeAll(expression);
+    const QString id = watchIds.take(expression);
+    if (!id.isEmpty()) send("-var-delete " + id.toUtf8());
+}
+
+void DebugSession::createWatch(const QString &expression)
+{
+    // “@” 为浮动变量对象：每次更新都在当前栈帧重新求值
+    watchIds.insert(expression, QString());
+    send("-var-create - @ " + GdbMiRecord::quote(expression), [this, expression](const GdbMiRecord &record) {
+        DebugVariable variable;
+        if (record.resultClass == "error") {
+            watchIds.remove(expression);   // 下次停下再试（例如变量尚未进入作用域）
+            variable.value = record.results["msg"].text();
+        } else {
+            variable = variableFrom(record.results);
+            if (watchExpressions.contains(expression)) {
+                watchIds.insert(expression, variable.id);
+            } else {
+                send("-var-delete " + variable.id.toUtf8());   // 回复前已被移除
+                return;
+            }
+        }
+        variable.expression = expression;
+        emit watchReady(expression, variable);
+    });
+}
@@ -0,0 +1,118 @@
+#ifndef DEBUGSESSION_H
+#define DEBUGSESSION_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QProcess>
+#include <QStringList>
+#include <functional>
+#include "gdbmi.h"
+
+// 调试器中的一个变量（对应 gdb 的变量对象）
+struct DebugVariable
+{
+    QString id;                  // 变量对象名，子项形如 var3.public.x；为空表示创建失败
+    QString expression;          // 显示的名字
+    QString value;               // 创建失败时为错误信息
+    QString type;
+    int childCount = 0;
+    bool hasMore = false;        // 还有未取的子项（容器按页取）
+    bool inScope = true;
+    bool childrenChanged = false; // 单步后子项数目或类型变了，已取的子项作废
+
+    bool isExpandable() const { return childCount > 0 || hasMore; }
+};
+
+// ----------------------------------------------------------------------
+// DebugSession：以 gdb --interpreter=mi 驱动一次调试
+// 命令带序号异步发出，回复按序号交给对应的回调，界面从不等待 gdb。
+// 局部变量和监视表达式都用变量对象表示：停下时若仍在同一函数，只做一次
+// -var-update 取回变了的值；换了函数才重建局部变量。子项只在展开时按页取，
+// 大容器不会拖慢单步。
+class DebugSession : public QObject
+{
+    Q_OBJECT
+public:
+    enum State { Idle, Starting, Running, Stopped };
+
+    explicit DebugSession(QObject *parent = nullptr);
+    ~DebugSession();
+
+    static QString findDebugger();              // 查找本机 gdb，找不到返回空
+
+    // breakpoints：文件 → 行号（从 1 开始）
+    // gdb 异步启动：返回 false 只表示没找到 gdb 或会话已在进行，启动失败经 output 报告
+    bool start(const QString &program, const QString &workingDir,
+               const QMultiHash<QString, int> &breakpoints);
+    void stop();
+    State state() const { return current; }
+    bool isActive() const { return current != Idle; }
+
+    void continueRun();
+    void stepOver();
+    void stepInto();
+    void stepOut();
+    void interrupt();
+
+    void insertBreakpoint(const QString &file, int line);
+    void removeBreakpoint(const QString &file, int line);
+
+    // 监视表达式在会话之间保留，每次停下时补建尚未建立的变量对象
+    QStringList watches() const { return watchExpressions; }
+    void addWatch(const QString &expression);
+    void removeWatch(const QString &expression);
+
+    // 取变量对象 id 的第 from 个起最多 count 个子项
+    void listChildren(const QString &id, int from, int count);
+
+signals:
+    void stateChanged(DebugSession::State state);
+    void stopped(const QString &file, int line, const QString &function, const QString &reason);
+    void exited(int exitCode);
+    void output(const QString &text);
+
+    void localsChanged(const QList<DebugVariable> &locals);      // 换了栈帧：整体替换
+    void variablesUpdated(const QList<DebugVariable> &changes);  // 值变了的变量（含监视和已展开的子项）
+    void watchReady(const QString &expression, const DebugVariable &variable);
+    void childrenReady(const QString &id, int from, const QList<DebugVariable> &children, bool hasMore);
+
+private slots:
+    void onReadyRead();
+    void onFinished();
+
+private:
+    using Handler = std::function<void(const GdbMiRecord &)>;
+
+    void sendStartupCommands(const QString &program, const QString &workingDir,
+                             const QMultiHash<QString, int> &initialBreakpoints);
+    void send(const QByteArray &command, const Handler &handler = Handler());
+    void execute(const QByteArray &command);
+    void handleRecord(const GdbMiRecord &record);
+    void handleStopped(const GdbMiValue &results);
+    void refreshVariables(const QString &frameKey);
+    void rebuildLocals(const QString &frameKey, const QStringList &names);
+    void updateVariables();
+    void createWatch(const QString &expression);
+    void setState(State state);
+    static DebugVariable variableFrom(const GdbMiValue &value);
+    static QString breakpointKey(const QString &file, int line);
+
+    QProcess *process = nullptr;
+    QByteArray readBuffer;
+    State current = Idle;
+
+    int nextToken = 1;
+    QHash<int, Handler> handlers;
+
+    QHash<QString, int> breakpoints;         // 文件:行 → gdb 断点编号
+
+    QString localsFrame;                     // 当前局部变量所属的函数
+    QStringList localNames;
+    QStringList localIds;
+
+    QStringList watchExpressions;
+    QHash<QString, QString> watchIds;        // 表达式 → 变量对象
+};
+
+#endif // DEBUGSESSION_H
@@ -0,0 +1,21 @@
+#ifndef DIAGNOSTIC_H
+#define DIAGNOSTIC_H
+
+#include <QString>
+#include <QList>
+
+// 编辑器中显示的一条诊断信息（行列均从 0 开始，列为 UTF-16 下标）
+struct Diagnostic
+{
+    enum Severity { Error = 1, Warning = 2, Information = 3, Hint = 4 };
+
+    int line = 0;
+    int column = 0;
+    int endLine = 0;
+    int endColumn = 0;
+    int severity = Error;
+    QString message;
+    QString source;   // clangd / gcc 等
+};
+
+#endif // DIAGNOSTIC_H
@@ -0,0 +1,271 @@
+#include "diffreview.h"
+#include "codeeditor.h"
+#include "linediff.h"
+
+#include <QEvent>
+#include <QFrame>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QVBoxLayout>
+
+namespace {
+const int kMaxPreviewLines = 15;
+}
+
+DiffReview *DiffReview::start(CodeEditor *editor, int firstLine,
+                              const QStringList &oldLines, const QStringList &newLines)
+{
+    const QList<DiffReview *> previous = editor->findChildren<DiffReview *>(QString(), Qt::FindDirectChildrenOnly);
+    for (DiffReview *review : previous)
+        review->rejectAll();
+
+    const QVector<LineHunk> diff = LineDiff::diff(oldLines, newLines);
+    if (diff.isEmpty()) return nullptr;
+
+    DiffReview *review = new DiffReview(editor);
+    QTextDocument *document = editor->document();
+    for (const LineHunk &lineHunk : diff) {
+        Hunk hunk;
+        const QTextBlock block = document->findBlockByNumber(firstLine + lineHunk.oldStart);
+        if (block.isValid()) {
+            hunk.anchor = QTextCursor(block);
+        } else {
+            hunk.atEnd = true;
+            hunk.anchor = QTextCursor(document);
+        }
+        hunk.oldLines = oldLines.mid(lineHunk.oldStart, lineHunk.oldCount);
+        hunk.newLines = newLines.mid(lineHunk.newStart, lineHunk.newCount);
+        review->hunks.append(hunk);
+    }
+    review->showCurrent();
+    return review;
+}
+
+bool DiffReview::extractCodeBlock(const QString &markdown, QString *code)
+{
+    const QStringList lines = markdown.split('\n');
+    int open = -1;
+    QString fence;
+    for (int i = 0; i < lines.size(); ++i) {
+        const QString trimmed = lines.at(i).trimmed();
+        if (open < 0) {
+            if (trimmed.startsWith("```") || trimmed.startsWith("~~~")) {
+                open = i;
+                fence = trimmed.left(3);
+            }
+        } else if (trimmed == fence || (trimmed.startsWith(fence) && trimmed.mid(3).trimmed().isEmpty())) {
+            *code = lines.mid(open + 1, i - open - 1).join('\n');
+            return true;
+        }
+    }
+    return false;   // 没有代码块，或回复被截断在代码块中间
+}
+
+DiffReview::DiffReview(CodeEditor *editor)
+    : QObject(editor)
+    , editor(editor)
+{
+    panel = new QFrame(editor->viewport());
+    panel->setObjectName("diffReviewPanel");
+    panel->setStyleSheet("#diffReviewPanel { background: #f3fbf3; border: 1px solid #8bbf8b; border-radius: 4px; }");
+
+    proposal = new QLabel(panel);
+    proposal->setTextFormat(Qt::PlainText);
+    proposal->setFont(editor->font());
+    proposal->setStyleSheet("color: #1f5f1f;");
+
+    counter = new QLabel(panel);
+    QPushButton *acceptButton = new QPushButton("接受", panel);
+    QPushButton *rejectButton = new QPushButton("拒绝", panel);
+    QPushButton *acceptAllButton = new QPushButton("全部接受", panel);
+    QPushButton *rejectAllButton = new QPushButton("全部拒绝", panel);
+    connect(acceptButton, &QPushButton::clicked, this, &DiffReview::acceptCurrent);
+    connect(rejectButton, &QPushButton::clicked, this, &DiffReview::rejectCurrent);
+    connect(acceptAllButton, &QPushButton::clicked, this, &DiffReview::acceptAll);
+    connect(rejectAllButton, &QPushButton::clicked, this, &DiffReview::rejectAll);
+
+    QHBoxLayout *buttons = new QHBoxLayout;
+    buttons->addWidget(counter);
+    buttons->addStretch();
+    buttons->addWidget(acceptButton);
+    buttons->addWidget(rejectButton);
+    buttons->addWidget(acceptAllButton);
+    buttons->addWidget(rejectAllButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(panel);
+    layout->setContentsMargins(8, 6, 8, 6);
+    layout->addWidget(proposal);
+    layout->addLayout(buttons);
+
+    // 浮窗跟随滚动和编辑移动
+    connect(editor->verticalScrollBar(), &QScrollBar::valueChanged, this, &DiffReview::placePanel);
+    connect(editor->horizontalScrollBar(), &QScrollBar::valueChanged, this, &DiffReview::placePanel);
+    connect(editor->document(), &QTextDocument::contentsChanged, this, &DiffReview::placePanel);
+    editor->viewport()->installEventFilter(this);
+}
+
+bool DiffReview::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Resize) placePanel();
+    return QObject::eventFilter(watched, event);
+}
+
+// ----------------- 审阅操作 -----------------
+void DiffReview::acceptCurrent()
+{
+    if (hunks.isEmpty() || !editor) return;
+    QTextCursor cursor(editor->document());
+    cursor.beginEditBlock();
+    if (apply(hunks.at(current))) ++accepted;
+    else ++skipped;
+    cursor.endEditBlock();
+    hunks.removeAt(current);
+    showCurrent();
+}
+
+void DiffReview::rejectCurrent()
+{
+    if (hunks.isEmpty()) return;
+    hunks.removeAt(current);
+    ++rejected;
+    showCurrent();
+}
+
+void DiffReview::acceptAll()
+{
+    if (editor && !hunks.isEmpty()) {
+        // 所有段在同一个编辑块里，撤销一次即可全部还原
+        QTextCursor cursor(editor->document());
+        cursor.beginEditBlock();
+        for (const Hunk &hunk : std::as_const(hunks)) {
+            if (apply(hunk)) ++accepted;
+            else ++skipped;
+        }
+        cursor.endEditBlock();
+    }
+    hunks.clear();
+    finishIfDone();
+}
+
+void DiffReview::rejectAll()
+{
+    rejected += hunks.size();
+    hunks.clear();
+    finishIfDone();
+}
+
+bool DiffReview::apply(const Hunk &hunk)
+{
+    QTextDocument *document = editor->document();
+    const int start = hunk.atEnd ? document->blockCount()
+                                 : document->findBlock(hunk.anchor.position()).blockNumber();
+
+    // 原文在审阅期间被改过：不覆盖用户的修改
+    for (int i = 0; i < hunk.oldLines.size(); ++i) {
+        const QTextBlock block = document->findBlockByNumber(start + i);
+        if (!block.isValid() || block.text() != hunk.oldLines.at(i)) return false;
+    }
+
+    LineHunk lineHunk;
+    lineHunk.oldStart = start;
+    lineHunk.oldCount = hunk.oldLines.size();
+    lineHunk.newStart = 0;
+    lineHunk.newCount = hunk.newLines.size();
+    LineDiff::applyHunk(document, lineHunk, hunk.newLines);
+    return true;
+}
+
+// ----------------- 显示 -----------------
+void DiffReview::showCurrent()
+{
+    if (hunks.isEmpty() || !editor) {
+        finishIfDone();
+        return;
+    }
+    current = qBound(0, current, int(hunks.size()) - 1);
+    const Hunk &hunk = hunks.at(current);
+
+    QStringList preview;
+    for (const QString &line : hunk.newLines.mid(0, kMaxPreviewLines))
+        preview.append("+ " + line);
+    if (hunk.newLines.size() > kMaxPreviewLines)
+        preview.append(QString("…（共 %1 行）").arg(hunk.newLines.size()));
+    if (hunk.newLines.isEmpty())
+        preview.append(QString("删除上方标红的 %1 行").arg(hunk.oldLines.size()));
+    proposal->setText(preview.join('\n'));
+    counter->setText(QString("修改 %1/%2").arg(current + 1).arg(hunks.size()));
+
+    // 光标移到该段，保证它在可见范围内
+    QTextCursor cursor = hunk.anchor;
+    if (hunk.atEnd) cursor.movePosition(QTextCursor::End);
+    cursor.movePosition(QTextCursor::StartOfBlock);
+    editor->setTextCursor(cursor);
+    editor->ensureCursorVisible();
+
+    updateHighlights();
+    placePanel();
+    panel->show();
+}
+
+void DiffReview::updateHighlights()
+{
+    QTextDocument *document = editor->document();
+    QList<QTextEdit::ExtraSelection> selections;
+    for (int i = 0; i < hunks.size(); ++i) {
+        const Hunk &hunk = hunks.at(i);
+        if (hunk.atEnd) continue;
+        QTextBlock block = document->findBlock(hunk.anchor.position());
+        const int count = qMax(1, int(hunk.oldLines.size()));
+        QColor color = hunk.oldLines.isEmpty() ? QColor(220, 245, 220) : QColor(255, 225, 225);
+        if (i == current) color = color.darker(110);
+        for (int line = 0; line < count && block.isValid(); ++line, block = block.next()) {
+            QTextEdit::ExtraSelection selection;
+            selection.cursor = QTextCursor(block);
+            selection.format.setBackground(color);
+            selection.format.setProperty(QTextFormat::FullWidthSelection, true);
+            selections.append(selection);
+        }
+    }
+    editor->setReviewSelections(selections);
+}
+
+void DiffReview::placePanel()
+{
+    if (!editor || hunks.isEmpty()) return;
+    const Hunk &hunk = hunks.at(current);
+    QTextDocument *document = editor->document();
+
+    // 放在原文最后一行下方；纯插入时放在插入点上一行下方
+    QTextBlock block = hunk.atEnd ? document->lastBlock() : document->findBlock(hunk.anchor.position());
+    if (!hunk.atEnd) {
+        if (hunk.oldLines.isEmpty()) block = block.previous().isValid() ? block.previous() : block;
+        else block = document->findBlockByNumber(block.blockNumber() + hunk.oldLines.size() - 1);
+    }
+    QTextCursor cursor(block);
+    cursor.movePosition(QTextCursor::EndOfBlock);
+
+    QWidget *viewport = editor->viewport();
+    panel->setFixedWidth(qMin(viewport->width() - 16, 760));
+    panel->adjustSize();
+    int y = editor->cursorRect(cursor).bottom() + 2;
+    y = qBound(0, y, qMax(0, viewport->height() - panel->height()));
+    panel->move(8, y);
+    panel->raise();
+}
+
+void DiffReview::finishIfDone()
+{
+    if (done || !hunks.isEmpty()) return;
+    done = true;
+    if (editor) {
+        editor->setReviewSelections({});
+        editor->viewport()->removeEventFilter(this);
+        panel->deleteLater();
+    }
+    emit finished(accepted, rejected, skipped);
+    deleteLater();
+}
@@ -0,0 +1,75 @@
+#ifndef DIFFREVIEW_H
+#define DIFFREVIEW_H
+
+#include <QObject>
+#include <QPointer>
+#include <QStringList>
+#include <QTextCursor>
+#include <QVector>
+
+class CodeEditor;
+class QFrame;
+class QLabel;
+
+// ----------------------------------------------------------------------
+// DiffReview：在编辑器里逐段审阅一组建议的修改
+// 建议文本与编辑器中 firstLine 起的原文做行级差分，每个差异段的原文标红，
+// 当前段下方浮出建议的新内容和“接受 / 拒绝”按钮。接受时只替换该段的行，
+// 一段（或“全部接受”的所有段）是一个撤销步骤；文档不会被整体重设。
+// 差异段的位置用 QTextCursor 跟踪，审阅期间在别处编辑不影响定位；
+// 某段原文若已被改动，则跳过该段。
+class DiffReview : public QObject
+{
+    Q_OBJECT
+public:
+    // 开始审阅；同一编辑器上未完成的审阅会被放弃。没有差异时返回 nullptr
+    static DiffReview *start(CodeEditor *editor, int firstLine,
+                             const QStringList &oldLines, const QStringList &newLines);
+
+    // 取出 Markdown 中第一个围栏代码块的内容；没有时返回 false
+    static bool extractCodeBlock(const QString &markdown, QString *code);
+
+    int pendingCount() const { return hunks.size(); }
+
+public slots:
+    void acceptCurrent();
+    void rejectCurrent();
+    void acceptAll();
+    void rejectAll();
+
+signals:
+    void finished(int accepted, int rejected, int skipped);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Hunk
+    {
+        QTextCursor anchor;      // 原文首行的行首；纯插入时为插入点所在行
+        bool atEnd = false;      // 追加到文档末尾
+        QStringList oldLines;
+        QStringList newLines;
+    };
+
+    explicit DiffReview(CodeEditor *editor);
+    bool apply(const Hunk &hunk);   // 原文已变时返回 false
+    void showCurrent();
+    void updateHighlights();
+    void placePanel();
+    void finishIfDone();
+
+    QPointer<CodeEditor> editor;
+    QVector<Hunk> hunks;
+    int current = 0;
+    int accepted = 0;
+    int rejected = 0;
+    int skipped = 0;
+    bool done = false;
+
+    QFrame *panel = nullptr;
+    QLabel *proposal = nullptr;
+    QLabel *counter = nullptr;
+};
+
+#endif // DIFFREVIEW_H
@@ -0,0 +1,88 @@
+#include "filesaver.h"
+
+#include <QFutureWatcher>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+FileSaver::FileSaver(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void FileSaver::save(const QString &path, const QString &text, const TextFormat &format)
+{
+    const Snapshot snapshot{ text, format };
+    if (running.contains(path)) {
+        queued.insert(path, snapshot);
+        return;
+    }
+    start(path, snapshot);
+}
+
+bool FileSaver::isSaving(const QString &path) const
+{
+    return running.contains(path) || queued.contains(path);
+}
+
+void FileSaver::start(const QString &path, const Snapshot &snapshot)
+{
+    Job job;
+    job.id = ++nextId;
+    job.text = snapshot.text;
+    job.future = QtConcurrent::run(&FileSaver::write, path, snapshot);
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    const int id = job.id;
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [=]() {
+        complete(path, id);
+        watcher->deleteLater();
+    });
+    watcher->setFuture(job.future);
+
+    running.insert(path, job);
+}
+
+void FileSaver::complete(const QString &path, int id)
+{
+    // waitForAll 可能已经同步处理过这一轮
+    auto it = running.find(path);
+    if (it == running.end() || it->id != id) return;
+
+    const Job job = it.value();
+    running.erase(it);
+    emit finished(path, job.text, job.future.result());
+
+    if (queued.contains(path))
+        start(path, queued.take(path));
+}
+
+void FileSaver::waitForAll()
+{
+    while (!running.isEmpty()) {
+        const QString path = running.constBegin().key();
+        const Job job = running.constBegin().value();
+        job.future.waitForFinished();
+        complete(path, job.id);
+    }
+}
+
+QString FileSaver::write(const QString &path, const Snapshot &snapshot)
+{
+    // 工作线程：编码 + 写临时文件 + 同步到磁盘 + 原子重命名
+    QString error;
+    const QByteArray data = TextFile::encode(snapshot.text, snapshot.format, &error);
+    if (!error.isEmpty())
+        return error;
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))   // 换行已由 encode 按原文件格式还原，这里不再转换
+        return file.errorString();
+    if (file.write(data) != data.size()) {
+        const QString error = file.errorString();
+        file.cancelWriting();
+        return error;
+    }
+    if (!file.commit())   // commit 会先 fsync 临时文件，再替换目标文件
+        return file.errorString();
+    return QString();
+}
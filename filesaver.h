@@ -0,0 +1,56 @@
+#ifndef FILESAVER_H
+#define FILESAVER_H
+
+#include <QObject>
+#include <QFuture>
+#include <QHash>
+#include <QString>
+#include "textfile.h"
+
+// ----------------------------------------------------------------------
+// FileSaver：后台原子保存
+// 主线程只取文档快照；编码与写盘在工作线程完成：先写同目录临时文件并刷到磁盘，
+// 再原子地替换目标文件（QSaveFile），崩溃或磁盘写满时原文件保持完整。
+// 不同文件并行保存；同一文件上一轮未写完时只保留最新快照排队，写完再接着写。
+// 按打开时检测到的编码与换行写回（见 TextFile）。
+class FileSaver : public QObject
+{
+    Q_OBJECT
+public:
+    explicit FileSaver(QObject *parent = nullptr);
+
+    void save(const QString &path, const QString &text, const TextFormat &format);
+    bool isSaving(const QString &path) const;
+    bool isBusy() const { return !running.isEmpty(); }
+
+    // 阻塞直到所有保存（包括排队中的）完成，编译和退出前调用
+    void waitForAll();
+
+signals:
+    // error 为空表示成功
+    void finished(const QString &path, const QString &text, const QString &error);
+
+private:
+    struct Snapshot
+    {
+        QString text;
+        TextFormat format;
+    };
+
+    struct Job
+    {
+        QFuture<QString> future;
+        QString text;
+        int id = 0;
+    };
+
+    void start(const QString &path, const Snapshot &snapshot);
+    void complete(const QString &path, int id);
+    static QString write(const QString &path, const Snapshot &snapshot);
+
+    QHash<QString, Job> running;
+    QHash<QString, Snapshot> queued;   // 路径 -> 最新的待写快照
+    int nextId = 0;
+};
+
+#endif // FILESAVER_H
@@ -0,0 +1,94 @@
+#include "fontservice.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QFontDatabase>
+#include <QFutureWatcher>
+#include <QtConcurrent>
+
+namespace {
+const char *const kFontFiles[] = {
+    ":/new/prefix2/fonts/JetBrainsMonoNL-Bold.ttf",   // 第一个作为编辑器默认字体
+    ":/new/prefix2/fonts/FiraCode-Regular.ttf",
+    ":/new/prefix2/fonts/FiraCode-Bold.ttf",
+    ":/new/prefix2/fonts/IBMPlexMono-Bold.ttf",
+};
+const int kEditorPointSize = 14;
+}
+
+FontService::FontService(QObject *parent)
+    : QObject(parent)
+{
+}
+
+FontService *FontService::instance()
+{
+    static FontService *service = new FontService(QCoreApplication::instance());
+    return service;
+}
+
+void FontService::loadFonts()
+{
+    if (ready || future.isStarted()) return;
+
+    // Qt 6 中 QFontDatabase 的注册接口是线程安全的，读取资源和解析字体都放到工作线程
+    future = QtConcurrent::run([]() {
+        QStringList families;
+        for (const char *path : kFontFiles) {
+            QFile file(QString::fromLatin1(path));
+            if (!file.open(QIODevice::ReadOnly)) {
+                families.append(QString());
+                continue;
+            }
+            const int id = QFontDatabase::addApplicationFontFromData(file.readAll());
+            const QStringList loaded = id != -1 ? QFontDatabase::applicationFontFamilies(id) : QStringList();
+            families.append(loaded.isEmpty() ? QString() : loaded.first());
+        }
+        return families;
+    });
+
+    auto *watcher = new QFutureWatcher<QStringList>(this);
+    connect(watcher, &QFutureWatcher<QStringList>::finished, this, [=]() {
+        applyResult();
+        watcher->deleteLater();
+    });
+    watcher->setFuture(future);
+}
+
+void FontService::applyResult()
+{
+    if (ready) return;
+    ready = true;
+
+    const QString family = future.result().value(0);
+
+    if (!family.isEmpty()) {
+        defaultEditorFont = QFont(family);
+        defaultEditorFont.setPointSize(kEditorPointSize);
+        defaultEditorFont.setStyleHint(QFont::Monospace);
+        defaultEditorFont.setFixedPitch(true);        // JetBrains Mono 是等宽字体
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+        defaultEditorFont.setStyleStrategy(QFont::PreferAntialias);
+        defaultEditorFont.setKerning(true);
+#endif
+        qDebug() << "Loaded font:" << family;
+    } else {
+        defaultEditorFont = QFontDatabase::systemFont(QFontDatabase::FixedFont);
+        defaultEditorFont.setPointSize(kEditorPointSize);
+        qDebug() << "Failed to load JetBrains Mono font, fallback to system default";
+    }
+
+    emit fontsReady();
+}
+
+QFont FontService::editorFont()
+{
+    if (!ready) {
+        // 启动后立即打开文件时，注册可能还没结束
+        loadFonts();
+        future.waitForFinished();
+        applyResult();
+    }
+    return defaultEditorFont;
+}
@@ -0,0 +1,38 @@
+#ifndef FONTSERVICE_H
+#define FONTSERVICE_H
+
+#include <QObject>
+#include <QFont>
+#include <QFuture>
+#include <QStringList>
+
+// ----------------------------------------------------------------------
+// FontService：进程内共享的字体服务
+// 启动时在后台线程把 Source.qrc 中的字体注册一次，之后所有编辑器共用同一个 QFont
+// （QFont 隐式共享，字体引擎和度量缓存也随之共享），打开新标签页不再重复解析 TTF。
+class FontService : public QObject
+{
+    Q_OBJECT
+public:
+    static FontService *instance();
+
+    // 启动后台注册，重复调用无副作用
+    void loadFonts();
+    bool isReady() const { return ready; }
+
+    // 编辑器默认字体；若后台注册尚未完成则等待其结束
+    QFont editorFont();
+
+signals:
+    void fontsReady();
+
+private:
+    explicit FontService(QObject *parent = nullptr);
+    void applyResult();
+
+    QFuture<QStringList> future;   // 结果与字体文件一一对应，加载失败处为空串
+    bool ready = false;
+    QFont defaultEditorFont;
+};
+
+#endif // FONTSERVICE_H
@@ -0,0 +1,197 @@
+#include "gdbmi.h"
+
+// ----------------- 解析器 -----------------
+// 语法见 GDB 手册 “GDB/MI Output Syntax”：
+//   value  → const | tuple | list
+//   tuple  → "{}" | "{" result ( "," result )* "}"
+//   list   → "[]" | "[" value ( "," value )* "]" | "[" result ( "," result )* "]"
+//   result → variable "=" value
+// 字符串中的非 ASCII 字节以八进制转义给出，整段解出字节后再按 UTF-8 解码。
+class GdbMiParser
+{
+public:
+    explicit GdbMiParser(const QByteArray &text, int from) : s(text), i(from) {}
+
+    bool atEnd() const { return i >= s.size(); }
+    char peek() const { return atEnd() ? '\0' : s.at(i); }
+    bool consume(char ch)
+    {
+        if (peek() != ch) return false;
+        ++i;
+        return true;
+    }
+
+    QString cString()
+    {
+        QByteArray bytes;
+        if (!consume('"')) return QString();
+        while (!atEnd() && peek() != '"') {
+            char ch = s.at(i++);
+            if (ch != '\\' || atEnd()) {
+                bytes += ch;
+                continue;
+            }
+            ch = s.at(i++);
+            switch (ch) {
+            case 'n': bytes += '\n'; break;
+            case 't': bytes += '\t'; break;
+            case 'r': bytes += '\r'; break;
+            case 'a': bytes += '\a'; break;
+            case 'b': bytes += '\b'; break;
+            case 'f': bytes += '\f'; break;
+            case 'v': bytes += '\v'; break;
+            case 'e': bytes += '\x1b'; break;
+            default:
+                if (ch >= '0' && ch <= '7') {
+                    int code = ch - '0';
+                    for (int n = 0; n < 2 && peek() >= '0' && peek() <= '7'; ++n)
+                        code = code * 8 + (s.at(i++) - '0');
+                    bytes += char(code);
+                } else {
+                    bytes += ch;   // \" \\ 以及其他
+                }
+            }
+        }
+        consume('"');
+        return QString::fromUtf8(bytes);
+    }
+
+    QString variable()
+    {
+        const int start = i;
+        while (!atEnd() && peek() != '=' && peek() != ',' && peek() != '}' && peek() != ']')
+            ++i;
+        return QString::fromLatin1(s.mid(start, i - start));
+    }
+
+    GdbMiValue value()
+    {
+        GdbMiValue result;
+        if (peek() == '"') {
+            result.type = GdbMiValue::Const;
+            result.data = cString();
+        } else if (consume('{')) {
+            result.type = GdbMiValue::Tuple;
+            parseItems(result, '}');
+        } else if (consume('[')) {
+            result.type = GdbMiValue::List;
+            parseItems(result, ']');
+        }
+        return result;
+    }
+
+    GdbMiValue result()
+    {
+        const QString name = variable();
+        if (!consume('=')) return GdbMiValue();
+        GdbMiValue item = value();
+        item.key = name;
+        return item;
+    }
+
+    // 逗号分隔的 name=value，直到行尾
+    void parseResults(GdbMiValue &target)
+    {
+        target.type = GdbMiValue::Tuple;
+        while (consume(',')) {
+            const GdbMiValue item = result();
+            if (!item.isValid()) return;
+            target.items.append(item);
+        }
+    }
+
+private:
+    void parseItems(GdbMiValue &target, char close)
+    {
+        if (consume(close)) return;
+        do {
+            // 列表元素可能是裸值，也可能是 name=value
+            const GdbMiValue item = (peek() == '"' || peek() == '{' || peek() == '[') ? value() : result();
+            if (!item.isValid()) return;
+            target.items.append(item);
+        } while (consume(','));
+        consume(close);
+    }
+
+    const QByteArray &s;
+    int i;
+};
+
+// ----------------- GdbMiValue -----------------
+int GdbMiValue::toInt(int defaultValue) const
+{
+    bool ok = false;
+    const int number = data.toInt(&ok);
+    return ok ? number : defaultValue;
+}
+
+const GdbMiValue &GdbMiValue::operator[](const char *name) const
+{
+    static const GdbMiValue invalid;
+    const QLatin1String wanted(name);
+    for (const GdbMiValue &item : items) {
+        if (item.key == wanted) return item;
+    }
+    return invalid;
+}
+
+// ----------------- GdbMiRecord -----------------
+GdbMiRecord GdbMiRecord::parse(const QByteArray &line)
+{
+    GdbMiRecord record;
+    QByteArray text = line;
+    while (text.endsWith('\n') || text.endsWith('\r'))
+        text.chop(1);
+
+    if (text.startsWith("(gdb)")) {
+        record.type = Prompt;
+        return record;
+    }
+
+    int i = 0;
+    while (i < text.size() && text.at(i) >= '0' && text.at(i) <= '9')
+        ++i;
+    if (i > 0) record.token = text.left(i).toInt();
+    if (i >= text.size()) return record;
+
+    const char kind = text.at(i);
+    switch (kind) {
+    case '^': record.type = Result; break;
+    case '*': record.type = Exec; break;
+    case '+': record.type = Status; break;
+    case '=': record.type = Notify; break;
+    case '~': record.type = Console; break;
+    case '@': record.type = Target; break;
+    case '&': record.type = Log; break;
+    default: return record;   // 不是 MI 输出（例如被调试程序直接写到终端的内容）
+    }
+
+    GdbMiParser parser(text, i + 1);
+    if (record.type == Console || record.type == Target || record.type == Log) {
+        if (parser.peek() != '"') {
+            record.type = Invalid;
+            return record;
+        }
+        record.stream = parser.cString();
+        return record;
+    }
+
+    record.resultClass = parser.variable();
+    parser.parseResults(record.results);
+    return record;
+}
+
+QByteArray GdbMiRecord::quote(const QString &text)
+{
+    QByteArray quoted = "\"";
+    for (char ch : text.toUtf8()) {
+        if (ch == '"' || ch == '\\') quoted += '\\';
+        if (ch == '\n') {
+            quoted += "\\n";
+            continue;
+        }
+        quoted += ch;
+    }
+    quoted += '"';
+    return quoted;
+}
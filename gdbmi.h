@@ -0,0 +1,60 @@
+#ifndef GDBMI_H
+#define GDBMI_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+
+// ----------------------------------------------------------------------
+// GdbMiValue：GDB/MI 输出中的值（常量字符串、元组 {...} 或列表 [...]）
+// 元组和“结果列表”的元素带名字，按名字查找；缺失时返回无效值，可以连续下标。
+class GdbMiValue
+{
+public:
+    enum Kind { Invalid, Const, Tuple, List };
+
+    Kind kind() const { return type; }
+    bool isValid() const { return type != Invalid; }
+    QString name() const { return key; }
+
+    QString text() const { return data; }
+    int toInt(int defaultValue = 0) const;
+    const QList<GdbMiValue> &children() const { return items; }
+    const GdbMiValue &operator[](const char *name) const;
+
+private:
+    friend class GdbMiParser;
+    Kind type = Invalid;
+    QString key;
+    QString data;
+    QList<GdbMiValue> items;
+};
+
+// GdbMiRecord：一行 MI 输出
+struct GdbMiRecord
+{
+    enum Type {
+        Invalid,
+        Result,      // [token]^done / ^running / ^error ...
+        Exec,        // *stopped / *running
+        Status,      // +...
+        Notify,      // =thread-group-exited ...
+        Console,     // ~"..." 命令行输出
+        Target,      // @"..." 被调试程序的输出
+        Log,         // &"..." gdb 内部日志
+        Prompt       // (gdb)
+    };
+
+    Type type = Invalid;
+    int token = -1;
+    QString resultClass;     // done / stopped / error ...
+    GdbMiValue results;      // 以元组形式保存 class 之后的 name=value
+    QString stream;          // 流记录的内容
+
+    static GdbMiRecord parse(const QByteArray &line);
+
+    // MI 命令参数中的 C 字符串
+    static QByteArray quote(const QString &text);
+};
+
+#endif // GDBMI_H
@@ -0,0 +1,116 @@
+#include "gutterrenderer.h"
+#include "blockdata.h"
+#include "diagnostic.h"
+
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPolygonF>
+
+void GutterRenderer::setFont(const QFont &font, qreal devicePixelRatio)
+{
+    if (!atlas.isNull() && font == atlasFont && devicePixelRatio == atlasRatio) return;
+
+    atlasFont = font;
+    atlasRatio = devicePixelRatio;
+
+    const QFontMetrics metrics(font);
+    advance = 0;
+    for (char d = '0'; d <= '9'; ++d)
+        advance = qMax(advance, metrics.horizontalAdvance(QLatin1Char(d)));
+    height = metrics.height();
+
+    // 按物理像素建图，高分屏下贴图不会发虚
+    atlas = QPixmap(QSize(advance * 10, height) * devicePixelRatio);
+    atlas.setDevicePixelRatio(devicePixelRatio);
+    atlas.fill(Qt::transparent);
+
+    QPainter painter(&atlas);
+    painter.setFont(font);
+    painter.setPen(Qt::black);
+    for (int d = 0; d < 10; ++d)
+        painter.drawText(QRect(d * advance, 0, advance, height), Qt::AlignCenter, QString(QLatin1Char('0' + d)));
+}
+
+void GutterRenderer::paintRow(QPainter &painter, const QRect &rect, const Row &row) const
+{
+    const QRect markerCell(rect.left(), rect.top(), markerWidth(), height);
+    const QRect foldCell(rect.right() + 1 - foldWidth(), rect.top(), foldWidth(), height);
+
+    drawMarkers(painter, markerCell, row);
+    drawNumber(painter, foldCell.left() - 2, rect.top(), row.lineNumber);
+    drawFoldMarker(painter, foldCell, row.fold);
+}
+
+void GutterRenderer::drawNumber(QPainter &painter, int right, int top, int number) const
+{
+    if (atlas.isNull()) return;
+
+    // 从个位开始向左逐位贴图
+    const qreal ratio = atlas.devicePixelRatio();
+    int x = right;
+    do {
+        x -= advance;
+        const int digit = number % 10;
+        painter.drawPixmap(QRectF(x, top, advance, height), atlas,
+                           QRectF(digit * advance * ratio, 0, advance * ratio, height * ratio));
+        number /= 10;
+    } while (number > 0);
+}
+
+void GutterRenderer::drawMarkers(QPainter &painter, const QRect &cell, const Row &row) const
+{
+    if (!row.markers && !row.diagnosticSeverity) return;
+
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+
+    const QPointF center = QRectF(cell).center();
+    const qreal r = height / 3.0;
+
+    if (row.markers & BlockData::BreakpointMarker) {
+        painter.setBrush(QColor(200, 30, 30));
+        painter.drawEllipse(center, r, r);
+    } else if (row.diagnosticSeverity) {
+        // 没有断点时用小方块提示本行的诊断级别
+        const QColor color = row.diagnosticSeverity == Diagnostic::Error ? QColor(Qt::red)
+                             : row.diagnosticSeverity == Diagnostic::Warning ? QColor(255, 140, 0)
+                                                                              : QColor(Qt::blue);
+        painter.setBrush(color);
+        painter.drawRect(QRectF(center.x() - r / 2, center.y() - r / 2, r, r));
+    }
+
+    if (row.markers & BlockData::ExecutionMarker) {
+        // 调试器当前执行行：黄色箭头
+        QPolygonF arrow;
+        arrow << QPointF(center.x() - r, center.y() - r / 2) << QPointF(center.x(), center.y() - r / 2)
+              << QPointF(center.x(), center.y() - r) << QPointF(center.x() + r, center.y())
+              << QPointF(center.x(), center.y() + r) << QPointF(center.x(), center.y() + r / 2)
+              << QPointF(center.x() - r, center.y() + r / 2);
+        painter.setBrush(QColor(240, 200, 0));
+        painter.setPen(QColor(120, 100, 0));
+        painter.drawPolygon(arrow);
+    }
+    painter.restore();
+}
+
+void GutterRenderer::drawFoldMarker(QPainter &painter, const QRect &cell, FoldMarker fold) const
+{
+    if (fold == NoFoldMarker) return;
+
+    // 折叠标记：展开为 ▼，折叠为 ▶
+    const QPointF c = QRectF(cell).center();
+    const qreal r = cell.width() / 4.0;
+    QPolygonF triangle;
+    if (fold == Collapsed)
+        triangle << QPointF(c.x() - r / 2, c.y() - r) << QPointF(c.x() + r, c.y()) << QPointF(c.x() - r / 2, c.y() + r);
+    else
+        triangle << QPointF(c.x() - r, c.y() - r / 2) << QPointF(c.x() + r, c.y() - r / 2) << QPointF(c.x(), c.y() + r);
+
+    painter.save();
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+    painter.setBrush(QColor(90, 90, 90));
+    painter.drawPolygon(triangle);
+    painter.restore();
+}
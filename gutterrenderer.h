@@ -0,0 +1,51 @@
+#ifndef GUTTERRENDERER_H
+#define GUTTERRENDERER_H
+
+#include <QFont>
+#include <QPixmap>
+#include <QRect>
+
+class QPainter;
+
+// ----------------------------------------------------------------------
+// GutterRenderer：行号区的逐行绘制
+// 数字 0-9 预先渲染到一张图集中，绘制行号时只做贴图，不再为每行构造 QString
+// 和排版文本。每行从左到右依次为：标记列（断点、诊断等）、行号、折叠标记。
+class GutterRenderer
+{
+public:
+    enum FoldMarker { NoFoldMarker, Expanded, Collapsed };
+
+    struct Row
+    {
+        int lineNumber = 0;         // 从 1 开始
+        int markers = 0;            // BlockData::Marker 位掩码
+        int diagnosticSeverity = 0; // 0 表示本行无诊断
+        FoldMarker fold = NoFoldMarker;
+    };
+
+    // 字体或设备像素比变化时重建图集
+    void setFont(const QFont &font, qreal devicePixelRatio);
+
+    int digitWidth() const { return advance; }
+    int lineHeight() const { return height; }
+    int markerWidth() const { return height; }
+    int foldWidth() const { return height; }
+    int widthFor(int digits) const { return markerWidth() + advance * digits + 3 + foldWidth(); }
+
+    // rect 为该行在行号区中的矩形（高度为块高度）
+    void paintRow(QPainter &painter, const QRect &rect, const Row &row) const;
+
+private:
+    void drawNumber(QPainter &painter, int right, int top, int number) const;
+    void drawMarkers(QPainter &painter, const QRect &cell, const Row &row) const;
+    void drawFoldMarker(QPainter &painter, const QRect &cell, FoldMarker fold) const;
+
+    QPixmap atlas;
+    QFont atlasFont;
+    qreal atlasRatio = 0;
+    int advance = 0;   // 单个数字的宽度（取 0-9 中最宽者）
+    int height = 0;
+};
+
+#endif // GUTTERRENDERER_H
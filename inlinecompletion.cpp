@@ -0,0 +1,172 @@
+#include "inlinecompletion.h"
+#include "aiclient.h"
+#include "codeeditor.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QTextBlock>
+
+#include <memory>
+
+namespace {
+const int kDebounceMs = 350;
+const int kPrefixChars = 3000;       // 发给模型的光标前文本
+const int kSuffixChars = 1000;
+const int kCacheKeyChars = 256;      // 缓存比对用的光标前文本长度
+const int kMaxCached = 32;
+const int kMaxLines = 8;
+}
+
+InlineCompletion::InlineCompletion(CodeEditor *editor)
+    : QObject(editor)
+    , editor(editor)
+{
+    debounce.setSingleShot(true);
+    debounce.setInterval(kDebounceMs);
+    connect(&debounce, &QTimer::timeout, this, &InlineCompletion::request);
+    connect(editor, &QPlainTextEdit::textChanged, this, &InlineCompletion::onTextChanged);
+}
+
+void InlineCompletion::onTextChanged()
+{
+    // 高亮器的格式刷新也会发出 textChanged，文档修订号不变
+    const int revision = editor->document()->revision();
+    if (revision == lastRevision) return;
+    lastRevision = revision;
+
+    cancel();
+    debounce.stop();
+    if (!editor->hasFocus() || !editor->ghostText().isEmpty()) return;   // 正沿着建议输入
+    debounce.start();
+}
+
+AiClient *InlineCompletion::client()
+{
+    if (!aiClient) aiClient = AiClient::instance();
+    return aiClient;
+}
+
+void InlineCompletion::cancel()
+{
+    if (inFlight) inFlight->cancel();
+    inFlight = nullptr;
+}
+
+bool InlineCompletion::canSuggest() const
+{
+    if (!editor || !editor->hasFocus() || editor->isReadOnly() || editor->cursorCount() > 1) return false;
+    const QTextCursor cursor = editor->textCursor();
+    if (cursor.hasSelection()) return false;
+
+    // 只在行尾（后面只剩空白或右括号之类）给建议，避免遮住同一行后面的代码
+    const QString rest = cursor.block().text().mid(cursor.positionInBlock());
+    for (QChar ch : rest) {
+        if (!ch.isSpace() && !QStringLiteral(")]};,\"'").contains(ch)) return false;
+    }
+    // 刚输完的这一行全是空白（比如回车后）时不打扰
+    return !cursor.block().text().left(cursor.positionInBlock()).trimmed().isEmpty();
+}
+
+void InlineCompletion::request()
+{
+    if (!canSuggest()) return;
+    AiClient *client = this->client();
+    if (!client->settings().inlineCompletion) return;
+
+    QTextDocument *document = editor->document();
+    const int position = editor->textCursor().position();
+    const int prefixStart = qMax(0, position - kPrefixChars);
+    const QString prefix = editor->toPlainText().mid(prefixStart, position - prefixStart);
+
+    const QString cached = fromCache(prefix);
+    if (!cached.isEmpty()) {
+        editor->setGhostText(position, cached);
+        return;
+    }
+
+    QString suffix;
+    for (int i = position; i < document->characterCount() - 1 && suffix.size() < kSuffixChars; ++i)
+        suffix += document->characterAt(i) == QChar::ParagraphSeparator ? QChar('\n') : document->characterAt(i);
+
+    QJsonArray messages;
+    messages.append(QJsonObject{
+        {"role", "system"},
+        {"content", "你是代码补全引擎。用户给出光标前后的代码，光标位置标为 <CURSOR>。"
+                    "只输出应在光标处插入的代码：不要重复光标前已有的内容，不要解释，不要使用 Markdown 代码块。"
+                    "补全尽量短，通常是当前语句的剩余部分或接下来的几行。"}
+    });
+    messages.append(QJsonObject{{"role", "user"}, {"content", prefix + "<CURSOR>" + suffix}});
+
+    AiReply *reply = client->streamChat(client->settings().codeModel, messages,
+                                        QJsonObject{{"temperature", 0.2}, {"max_tokens", 96}},
+                                        AiClient::Inline);
+    inFlight = reply;
+
+    // 边生成边显示；文档或光标一变，旧回复作废
+    const int revision = document->revision();
+    auto text = std::make_shared<QString>();
+    connect(reply, &AiReply::delta, this, [=](const QString &delta) {
+        if (!editor || document->revision() != revision || editor->textCursor().position() != position) {
+            reply->cancel();
+            return;
+        }
+        *text += delta;
+        editor->setGhostText(position, cleanSuggestion(*text));
+    });
+    connect(reply, &AiReply::finished, this, [=](bool ok, const QString &) {
+        if (inFlight == reply) inFlight = nullptr;
+        if (!ok) return;
+        const QString suggestion = cleanSuggestion(*text);
+        if (suggestion.isEmpty()) return;
+        remember(prefix, suggestion);
+        if (editor && document->revision() == revision && editor->textCursor().position() == position)
+            editor->setGhostText(position, suggestion);
+    });
+}
+
+QString InlineCompletion::fromCache(const QString &prefix) const
+{
+    // 缓存的 prefix + 建议的前 k 个字符 恰好是当前光标前的文本：剩余部分仍然有效
+    for (const Suggestion &suggestion : recent) {
+        for (int typed = 0; typed < suggestion.text.size(); ++typed) {
+            const QStringView typedPart = QStringView(suggestion.text).left(typed);
+            if (prefix.size() < typedPart.size()) break;
+            const QStringView before = QStringView(prefix).left(prefix.size() - typedPart.size());
+            if (QStringView(prefix).right(typedPart.size()) == typedPart && before.endsWith(suggestion.prefix))
+                return suggestion.text.mid(typed);
+        }
+    }
+    return QString();
+}
+
+void InlineCompletion::remember(const QString &prefix, const QString &text)
+{
+    Suggestion suggestion;
+    suggestion.prefix = prefix.right(kCacheKeyChars);
+    suggestion.text = text;
+    for (int i = 0; i < recent.size(); ++i) {
+        if (recent.at(i).prefix == suggestion.prefix) {
+            recent.removeAt(i);
+            break;
+        }
+    }
+    recent.prepend(suggestion);
+    if (recent.size() > kMaxCached) recent.removeLast();
+}
+
+QString InlineCompletion::cleanSuggestion(QString text)
+{
+    // 模型偶尔仍会包一层代码块
+    if (text.startsWith("```")) {
+        const int newline = text.indexOf('\n');
+        text = newline < 0 ? QString() : text.mid(newline + 1);
+    }
+    const int fence = text.indexOf("```");
+    if (fence >= 0) text.truncate(fence);
+    text.remove("<CURSOR>");
+
+    QStringList lines = text.split('\n');
+    if (lines.size() > kMaxLines) lines = lines.mid(0, kMaxLines);
+    while (!lines.isEmpty() && lines.last().trimmed().isEmpty()) lines.removeLast();
+    return lines.join('\n');
+}
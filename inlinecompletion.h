@@ -0,0 +1,52 @@
+#ifndef INLINECOMPLETION_H
+#define INLINECOMPLETION_H
+
+#include <QObject>
+#include <QPointer>
+#include <QList>
+#include <QString>
+#include <QTimer>
+
+class AiClient;
+class AiReply;
+class CodeEditor;
+
+// ----------------------------------------------------------------------
+// InlineCompletion：为一个编辑器提供 AI 行内建议（灰色提示）
+// 输入停顿后才请求（防抖）；再次输入立即取消进行中的请求。
+// 最近的建议按“请求时光标前的文本”缓存：沿着建议继续输入、或退格后重新输入时，
+// 直接从缓存取出剩余部分，不再发请求。建议由 CodeEditor 画在视口上，接受前不改动文档。
+// 每次按键只重启防抖计时器；AiClient 与设置到计时器触发时才用到。
+class InlineCompletion : public QObject
+{
+    Q_OBJECT
+public:
+    explicit InlineCompletion(CodeEditor *editor);
+
+private slots:
+    void onTextChanged();
+    void request();
+
+private:
+    struct Suggestion
+    {
+        QString prefix;          // 请求时光标前的文本（末尾一段）
+        QString text;
+    };
+
+    AiClient *client();
+    bool canSuggest() const;
+    QString fromCache(const QString &prefix) const;
+    void remember(const QString &prefix, const QString &text);
+    void cancel();
+    static QString cleanSuggestion(QString text);
+
+    QPointer<CodeEditor> editor;
+    AiClient *aiClient = nullptr;   // 首次请求时取得，之后复用
+    QTimer debounce;
+    QPointer<AiReply> inFlight;
+    int lastRevision = -1;
+    QList<Suggestion> recent;    // 最近使用的在前
+};
+
+#endif // INLINECOMPLETION_H
@@ -0,0 +1,202 @@
+#include "linediff.h"
+
+#include <QHash>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QTextDocument>
+
+namespace {
+const int kMaxEditDistance = 2000;   // 超过后整段替换，回溯表约 D² 个整数
+}
+
+QVector<LineHunk> LineDiff::diff(const QStringList &oldLines, const QStringList &newLines)
+{
+    // 每种行内容映射为一个整数，后续只比较整数
+    QHash<QString, int> ids;
+    QVector<int> a;
+    QVector<int> b;
+    a.reserve(oldLines.size());
+    b.reserve(newLines.size());
+    for (const QString &line : oldLines)
+        a.append(ids.insert(line, ids.value(line, ids.size())).value());
+    for (const QString &line : newLines)
+        b.append(ids.insert(line, ids.value(line, ids.size())).value());
+    return diffIds(a, b);
+}
+
+QVector<LineHunk> LineDiff::diffIds(const QVector<int> &a, const QVector<int> &b)
+{
+    QVector<LineHunk> hunks;
+
+    // 公共前缀与后缀
+    int prefix = 0;
+    while (prefix < a.size() && prefix < b.size() && a.at(prefix) == b.at(prefix))
+        ++prefix;
+    int suffix = 0;
+    while (suffix < a.size() - prefix && suffix < b.size() - prefix &&
+           a.at(a.size() - 1 - suffix) == b.at(b.size() - 1 - suffix))
+        ++suffix;
+
+    const int n = a.size() - prefix - suffix;
+    const int m = b.size() - prefix - suffix;
+    if (n == 0 && m == 0) return hunks;
+    if (n == 0 || m == 0) {
+        hunks.append({prefix, n, prefix, m});
+        return hunks;
+    }
+
+    const int *x0 = a.constData() + prefix;
+    const int *y0 = b.constData() + prefix;
+
+    // 前向搜索，trace[d] 保存第 d 轮开始前 k ∈ [-(d-1), d-1] 的 V 值
+    const int max = n + m;
+    QVector<int> v(2 * max + 2, 0);
+    const int offset = max + 1;
+    QVector<QVector<int>> trace;
+    int distance = -1;
+
+    for (int d = 0; d <= max && d <= kMaxEditDistance; ++d) {
+        QVector<int> slice;
+        if (d > 0) {
+            slice.reserve(2 * d - 1);
+            for (int k = -(d - 1); k <= d - 1; ++k)
+                slice.append(v[offset + k]);
+        }
+        trace.append(slice);
+
+        for (int k = -d; k <= d; k += 2) {
+            int x;
+            if (k == -d || (k != d && v[offset + k - 1] < v[offset + k + 1]))
+                x = v[offset + k + 1];          // 向下：插入
+            else
+                x = v[offset + k - 1] + 1;      // 向右：删除
+            int y = x - k;
+            while (x < n && y < m && x0[x] == y0[y]) {
+                ++x;
+                ++y;
+            }
+            v[offset + k] = x;
+            if (x >= n && y >= m) {
+                distance = d;
+                break;
+            }
+        }
+        if (distance >= 0) break;
+    }
+
+    if (distance < 0) {
+        // 差异太大，中间部分整体替换
+        hunks.append({prefix, n, prefix, m});
+        return hunks;
+    }
+
+    // 回溯得到逐行的编辑序列（倒序）：0 = 相同，1 = 删除旧行，2 = 插入新行
+    QVector<char> ops;
+    ops.reserve(n + m);
+    int x = n;
+    int y = m;
+    for (int d = distance; d > 0; --d) {
+        const QVector<int> &prev = trace.at(d);
+        auto value = [&](int k) { return prev.at(k + d - 1); };
+
+        const int k = x - y;
+        int prevK;
+        if (k == -d || (k != d && value(k - 1) < value(k + 1)))
+            prevK = k + 1;
+        else
+            prevK = k - 1;
+        const int prevX = value(prevK);
+        const int prevY = prevX - prevK;
+
+        while (x > prevX && y > prevY) {
+            ops.append(0);
+            --x;
+            --y;
+        }
+        ops.append(prevK == k + 1 ? 2 : 1);
+        x = prevX;
+        y = prevY;
+    }
+    while (x > 0 && y > 0) {
+        ops.append(0);
+        --x;
+        --y;
+    }
+
+    // 合并相邻的增删为差异段
+    int oldPos = 0;
+    int newPos = 0;
+    for (int i = ops.size() - 1; i >= 0;) {
+        if (ops.at(i) == 0) {
+            ++oldPos;
+            ++newPos;
+            --i;
+            continue;
+        }
+        LineHunk hunk;
+        hunk.oldStart = prefix + oldPos;
+        hunk.newStart = prefix + newPos;
+        while (i >= 0 && ops.at(i) != 0) {
+            if (ops.at(i) == 1) {
+                ++hunk.oldCount;
+                ++oldPos;
+            } else {
+                ++hunk.newCount;
+                ++newPos;
+            }
+            --i;
+        }
+        hunks.append(hunk);
+    }
+    return hunks;
+}
+
+void LineDiff::apply(QTextDocument *document, const QVector<LineHunk> &hunks, const QStringList &newLines)
+{
+    if (!document || hunks.isEmpty()) return;
+
+    QTextCursor cursor(document);
+    cursor.beginEditBlock();
+    // 从后往前应用，前面差异段的行号不受影响
+    for (int i = hunks.size() - 1; i >= 0; --i)
+        applyHunk(document, hunks.at(i), newLines);
+    cursor.endEditBlock();
+}
+
+void LineDiff::applyHunk(QTextDocument *document, const LineHunk &hunk, const QStringList &newLines)
+{
+    const QString replacement = newLines.mid(hunk.newStart, hunk.newCount).join('\n');
+    const int blockCount = document->blockCount();
+    QTextCursor cursor(document);
+
+    if (hunk.oldCount > 0 && hunk.newCount > 0) {
+        // 替换：从首行开头选到末行行尾（不含换行）
+        const QTextBlock first = document->findBlockByNumber(hunk.oldStart);
+        const QTextBlock last = document->findBlockByNumber(hunk.oldStart + hunk.oldCount - 1);
+        cursor.setPosition(first.position());
+        cursor.setPosition(last.position() + last.length() - 1, QTextCursor::KeepAnchor);
+        cursor.insertText(replacement);
+    } else if (hunk.oldCount == 0) {
+        // 纯插入：插在 oldStart 行之前；在末尾追加时换行放在前面
+        if (hunk.oldStart < blockCount) {
+            cursor.setPosition(document->findBlockByNumber(hunk.oldStart).position());
+            cursor.insertText(replacement + '\n');
+        } else {
+            cursor.movePosition(QTextCursor::End);
+            cursor.insertText('\n' + replacement);
+        }
+    } else {
+        // 纯删除：连同换行一起删；删到文档末尾时改删前一行的换行
+        const QTextBlock first = document->findBlockByNumber(hunk.oldStart);
+        const int endLine = hunk.oldStart + hunk.oldCount;
+        if (endLine < blockCount) {
+            cursor.setPosition(first.position());
+            cursor.setPosition(document->findBlockByNumber(endLine).position(), QTextCursor::KeepAnchor);
+        } else {
+            const QTextBlock previous = first.previous();
+            cursor.setPosition(previous.isValid() ? previous.position() + previous.length() - 1 : 0);
+            cursor.movePosition(QTextCursor::End, QTextCursor::KeepAnchor);
+        }
+        cursor.removeSelectedText();
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef LINEDIFF_H
+#define LINEDIFF_H
+
+#include <QStringList>
+#include <QVector>
+
+class QTextDocument;
+
+// 一段连续差异：旧文本从 oldStart 起的 oldCount 行替换为新文本从 newStart 起的 newCount 行
+struct LineHunk
+{
+    int oldStart = 0;
+    int oldCount = 0;
+    int newStart = 0;
+    int newCount = 0;
+};
+
+// ----------------------------------------------------------------------
+// LineDiff：按行的 Myers 差分
+// 先剥掉公共的头尾，再对中间部分做 O((N+M)D) 的最短编辑脚本；
+// 差异过大时退化为整段替换，保证耗时和内存有上界。
+class LineDiff
+{
+public:
+    static QVector<LineHunk> diff(const QStringList &oldLines, const QStringList &newLines);
+
+    // 在一个编辑块内把差异应用到文档（撤销为一步；未改动行上的光标、块数据保持不变）。
+    // 文档的块与 oldLines 一一对应（即 toPlainText().split('\n')）
+    static void apply(QTextDocument *document, const QVector<LineHunk> &hunks, const QStringList &newLines);
+
+    // 单个差异段，供逐段接受时使用；调用方负责从后往前应用以免行号错位
+    static void applyHunk(QTextDocument *document, const LineHunk &hunk, const QStringList &newLines);
+
+private:
+    static QVector<LineHunk> diffIds(const QVector<int> &a, const QVector<int> &b);
+};
+
+#endif // LINEDIFF_H
@@ -0,0 +1,653 @@
+#include "lspclient.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonValue>
+#include <QStandardPaths>
+#include <QTextBlock>
+#include <QTextCursor>
+#include <QUrl>
+
+namespace {
+const int kChangeDebounceMs = 150;   // didChange 合并窗口
+const int kRequestDebounceMs = 60;   // 补全/悬停防抖
+const int kSemanticDebounceMs = 800; // 语义高亮：整篇重新计算，只在输入停顿后请求
+}
+
+LspClient::LspClient(QObject *parent)
+    : QObject(parent)
+{
+    changeTimer.setSingleShot(true);
+    changeTimer.setInterval(kChangeDebounceMs);
+    connect(&changeTimer, &QTimer::timeout, this, &LspClient::flushChanges);
+
+    semanticTimer.setSingleShot(true);
+    semanticTimer.setInterval(kSemanticDebounceMs);
+    connect(&semanticTimer, &QTimer::timeout, this, &LspClient::refreshSemanticTokens);
+
+    requestTimer.setSingleShot(true);
+    requestTimer.setInterval(kRequestDebounceMs);
+    connect(&requestTimer, &QTimer::timeout, this, &LspClient::sendScheduledRequests);
+}
+
+LspClient::~LspClient()
+{
+    stop();
+}
+
+// ----------------- 服务器进程 -----------------
+QString LspClient::findServer()
+{
+    // 优先使用随 IDE 附带的 clangd，其次是 PATH 中的
+    const QString bundled = QDir(QCoreApplication::applicationDirPath()).filePath("mingw/bin");
+    QString path = QStandardPaths::findExecutable("clangd", {bundled});
+    if (path.isEmpty())
+        path = QStandardPaths::findExecutable("clangd");
+    return path;
+}
+
+bool LspClient::start(const QString &rootPath)
+{
+    if (isRunning()) return true;
+
+    const QString server = findServer();
+    if (server.isEmpty()) return false;
+
+    workspaceRoot = rootPath;
+    readBuffer.clear();
+    initialized = false;
+    outgoingQueue.clear();
+    inFlight.clear();
+    latestRequest.clear();
+
+    process = new QProcess(this);
+    process->setProgram(server);
+    process->setArguments({"--background-index", "--header-insertion=never", "--log=error"});
+    process->setStandardErrorFile(QProcess::nullDevice());
+    connect(process, &QProcess::readyReadStandardOutput, this, &LspClient::onReadyRead);
+    connect(process, &QProcess::finished, this, [this]() {
+        initialized = false;
+        inFlight.clear();
+        latestRequest.clear();
+        outgoingQueue.clear();
+    });
+
+    process->start();
+    if (!process->waitForStarted(3000)) {
+        process->deleteLater();
+        process = nullptr;
+        return false;
+    }
+
+    QJsonArray tokenTypes;
+    for (const char *type : {"namespace", "type", "class", "enum", "interface", "struct",
+                             "typeParameter", "parameter", "variable", "property", "enumMember",
+                             "function", "method", "macro", "keyword", "comment", "string",
+                             "number", "operator"})
+        tokenTypes.append(QString::fromLatin1(type));
+
+    QJsonObject textDocument{
+        {"synchronization", QJsonObject{{"didSave", true}}},
+        {"completion", QJsonObject{{"completionItem", QJsonObject{{"snippetSupport", false}}}}},
+        {"hover", QJsonObject{{"contentFormat", QJsonArray{"plaintext"}}}},
+        {"publishDiagnostics", QJsonObject{{"versionSupport", true}}},
+        {"semanticTokens", QJsonObject{
+             {"requests", QJsonObject{{"full", true}}},
+             {"tokenTypes", tokenTypes},
+             {"tokenModifiers", QJsonArray()},
+             {"formats", QJsonArray{"relative"}}}}
+    };
+
+    QJsonObject params{
+        {"processId", QCoreApplication::applicationPid()},
+        {"rootUri", rootPath.isEmpty() ? QJsonValue() : QJsonValue(QUrl::fromLocalFile(rootPath).toString(QUrl::FullyEncoded))},
+        {"capabilities", QJsonObject{
+             {"textDocument", textDocument},
+             {"general", QJsonObject{{"positionEncodings", QJsonArray{"utf-16"}}}}}},
+        {"initializationOptions", QJsonObject{{"fallbackFlags", QJsonArray{"-std=c++17"}}}}
+    };
+
+    PendingRequest context;
+    context.kind = Initialize;
+    sendRequest("initialize", params, context);
+
+    // 服务器崩溃后重启：仍在跟踪的文档重新 didOpen（排在 initialized 之后发出），
+    // 诊断与语义高亮不必等用户重新打开标签页
+    for (auto it = documents.begin(); it != documents.end(); ++it)
+        sendDidOpen(it.key(), it.value());
+    return true;
+}
+
+void LspClient::stop()
+{
+    if (!process) return;
+
+    if (process->state() == QProcess::Running) {
+        if (initialized) {
+            PendingRequest context;
+            context.kind = Initialize;
+            sendRequest("shutdown", QJsonObject(), context);
+            sendNotification("exit", QJsonObject());
+        }
+        process->closeWriteChannel();
+        if (!process->waitForFinished(300))
+            process->kill();
+    }
+
+    process->deleteLater();
+    process = nullptr;
+    initialized = false;
+}
+
+bool LspClient::isRunning() const
+{
+    return process && process->state() == QProcess::Running;
+}
+
+// ----------------- 文档同步 -----------------
+void LspClient::openDocument(QTextDocument *doc, const QString &filePath)
+{
+    if (!doc || filePath.isEmpty() || documents.contains(doc)) return;
+
+    DocumentState state;
+    state.uri = QUrl::fromLocalFile(QFileInfo(filePath).absoluteFilePath()).toString(QUrl::FullyEncoded);
+    documents.insert(doc, state);
+
+    connect(doc, &QTextDocument::contentsChange, this, &LspClient::onContentsChange);
+    connect(doc, &QObject::destroyed, this, &LspClient::onDocumentDestroyed);
+
+    sendDidOpen(doc, documents[doc]);
+}
+
+void LspClient::sendDidOpen(QTextDocument *doc, DocumentState &state)
+{
+    // 以文档当前内容为准，之前积攒的增量作废
+    ++state.version;
+    state.shadow = doc->toPlainText();
+    state.pendingChanges = QJsonArray();
+
+    const QString suffix = QFileInfo(QUrl(state.uri).toLocalFile()).suffix().toLower();
+    sendNotification("textDocument/didOpen", QJsonObject{
+        {"textDocument", QJsonObject{
+             {"uri", state.uri},
+             {"languageId", suffix == "c" ? "c" : "cpp"},
+             {"version", state.version},
+             {"text", state.shadow}}}
+    });
+
+    requestSemanticTokens(doc);
+}
+
+void LspClient::closeDocument(QTextDocument *doc)
+{
+    auto it = documents.find(doc);
+    if (it == documents.end()) return;
+
+    disconnect(doc, nullptr, this, nullptr);
+    sendNotification("textDocument/didClose", QJsonObject{
+        {"textDocument", QJsonObject{{"uri", it->uri}}}
+    });
+    documents.erase(it);
+}
+
+void LspClient::onDocumentDestroyed(QObject *obj)
+{
+    // 此时 QTextDocument 部分已析构，只能把指针当作键使用
+    QTextDocument *doc = static_cast<QTextDocument*>(obj);
+    auto it = documents.find(doc);
+    if (it == documents.end()) return;
+
+    sendNotification("textDocument/didClose", QJsonObject{
+        {"textDocument", QJsonObject{{"uri", it->uri}}}
+    });
+    documents.erase(it);
+}
+
+QString LspClient::documentText(QTextDocument *doc, int position, int length)
+{
+    if (length <= 0) return QString();
+
+    QTextCursor cursor(doc);
+    cursor.setPosition(position);
+    cursor.setPosition(position + length, QTextCursor::KeepAnchor);
+    QString text = cursor.selectedText();
+    text.replace(QChar::ParagraphSeparator, QLatin1Char('\n'));
+    text.replace(QChar::LineSeparator, QLatin1Char('\n'));
+    return text;
+}
+
+void LspClient::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    QTextDocument *doc = qobject_cast<QTextDocument*>(sender());
+    auto it = documents.find(doc);
+    if (it == documents.end()) return;
+    DocumentState &state = it.value();
+
+    // setPlainText 之后 Qt 会把末尾的段落分隔符也计入变更，超出文档的部分两侧同时扣除
+    const int docLength = doc->characterCount() - 1;
+    const int overflow = position + charsAdded - docLength;
+    if (overflow > 0) {
+        charsAdded -= overflow;
+        charsRemoved -= overflow;
+    }
+    if (position > state.shadow.length()) position = state.shadow.length();
+    charsAdded = qMax(0, charsAdded);
+    charsRemoved = qBound(0, charsRemoved, state.shadow.length() - position);
+
+    const QString removed = state.shadow.mid(position, charsRemoved);
+    const QString added = documentText(doc, position, charsAdded);
+    if (removed == added) return;   // 仅格式变化（例如查找高亮）
+
+    // 变更点之前的文本没有变化，因此起点可以直接在新文档中定位
+    const QTextBlock startBlock = doc->findBlock(position);
+    const int startLine = startBlock.blockNumber();
+    const int startColumn = position - startBlock.position();
+
+    const int removedLines = removed.count(QLatin1Char('\n'));
+    const int endLine = startLine + removedLines;
+    const int endColumn = removedLines
+                              ? removed.length() - removed.lastIndexOf(QLatin1Char('\n')) - 1
+                              : startColumn + removed.length();
+
+    state.shadow.replace(position, charsRemoved, added);
+    ++state.version;
+
+    if (state.shadow.length() != docLength) {
+        // 影子文本与文档失去同步，退回整篇同步
+        state.shadow = doc->toPlainText();
+        state.pendingChanges = QJsonArray{QJsonObject{{"text", state.shadow}}};
+    } else {
+        state.pendingChanges.append(QJsonObject{
+            {"range", QJsonObject{
+                 {"start", QJsonObject{{"line", startLine}, {"character", startColumn}}},
+                 {"end", QJsonObject{{"line", endLine}, {"character", endColumn}}}}},
+            {"text", added}
+        });
+    }
+
+    state.tokensStale = true;
+    changeTimer.start();
+    semanticTimer.start();
+}
+
+void LspClient::flushDocument(QTextDocument *doc)
+{
+    auto it = documents.find(doc);
+    if (it == documents.end() || it->pendingChanges.isEmpty()) return;
+
+    sendNotification("textDocument/didChange", QJsonObject{
+        {"textDocument", QJsonObject{{"uri", it->uri}, {"version", it->version}}},
+        {"contentChanges", it->pendingChanges}
+    });
+    it->pendingChanges = QJsonArray();
+}
+
+void LspClient::flushChanges()
+{
+    QList<QTextDocument*> changed;
+    for (auto it = documents.begin(); it != documents.end(); ++it) {
+        if (!it->pendingChanges.isEmpty())
+            changed.append(it.key());
+    }
+
+    for (QTextDocument *doc : changed)
+        flushDocument(doc);
+}
+
+void LspClient::refreshSemanticTokens()
+{
+    QList<QTextDocument*> stale;
+    for (auto it = documents.begin(); it != documents.end(); ++it) {
+        if (it->tokensStale)
+            stale.append(it.key());
+    }
+
+    for (QTextDocument *doc : stale)
+        requestSemanticTokens(doc);
+}
+
+// ----------------- 请求 -----------------
+void LspClient::requestCompletion(QTextDocument *doc, int position)
+{
+    if (!documents.contains(doc)) return;
+    scheduledCompletion.pending = true;
+    scheduledCompletion.doc = doc;
+    scheduledCompletion.position = position;
+    requestTimer.start();
+}
+
+void LspClient::requestHover(QTextDocument *doc, int position, const QPoint &globalPos)
+{
+    if (!documents.contains(doc)) return;
+    scheduledHover.pending = true;
+    scheduledHover.doc = doc;
+    scheduledHover.position = position;
+    scheduledHover.globalPos = globalPos;
+    requestTimer.start();
+}
+
+void LspClient::requestSemanticTokens(QTextDocument *doc)
+{
+    // 初始化前的请求会排队；初始化后服务器不支持语义高亮则跳过
+    if (!documents.contains(doc) || (initialized && semanticTokenTypes.isEmpty())) return;
+
+    flushDocument(doc);
+    cancelInFlight(doc, SemanticTokens);
+    documents[doc].tokensStale = false;
+
+    PendingRequest context;
+    context.kind = SemanticTokens;
+    context.doc = doc;
+    context.version = documents.value(doc).version;
+    sendRequest("textDocument/semanticTokens/full",
+                QJsonObject{{"textDocument", textDocumentId(doc)}}, context);
+}
+
+void LspClient::sendScheduledRequests()
+{
+    const RequestKind kinds[] = {Completion, Hover};
+    for (RequestKind kind : kinds) {
+        ScheduledRequest &scheduled = (kind == Completion) ? scheduledCompletion : scheduledHover;
+        if (!scheduled.pending) continue;
+        scheduled.pending = false;
+
+        QTextDocument *doc = scheduled.doc;
+        if (!documents.contains(doc)) continue;
+
+        // 先让服务器看到最新文本，再取消同类旧请求
+        flushDocument(doc);
+        cancelInFlight(doc, kind);
+
+        PendingRequest context;
+        context.kind = kind;
+        context.doc = doc;
+        context.version = documents.value(doc).version;
+        context.position = qBound(0, scheduled.position, doc->characterCount() - 1);
+        context.globalPos = scheduled.globalPos;
+
+        const QJsonObject params{
+            {"textDocument", textDocumentId(doc)},
+            {"position", positionObject(doc, context.position)}
+        };
+        sendRequest(kind == Completion ? "textDocument/completion" : "textDocument/hover",
+                    params, context);
+    }
+}
+
+void LspClient::cancelInFlight(QTextDocument *doc, RequestKind kind)
+{
+    const int id = latestRequest.take(qMakePair(doc, int(kind)));
+    if (id && inFlight.remove(id))
+        sendNotification("$/cancelRequest", QJsonObject{{"id", id}});
+}
+
+QJsonObject LspClient::positionObject(QTextDocument *doc, int position) const
+{
+    const QTextBlock block = doc->findBlock(position);
+    return QJsonObject{
+        {"line", block.blockNumber()},
+        {"character", position - block.position()}
+    };
+}
+
+QJsonObject LspClient::textDocumentId(QTextDocument *doc) const
+{
+    return QJsonObject{{"uri", documents.value(doc).uri}};
+}
+
+QTextDocument *LspClient::documentForUri(const QString &uri) const
+{
+    for (auto it = documents.constBegin(); it != documents.constEnd(); ++it) {
+        if (it->uri == uri) return it.key();
+    }
+    return nullptr;
+}
+
+// ----------------- JSON-RPC 传输 -----------------
+void LspClient::sendMessage(const QJsonObject &message)
+{
+    if (!isRunning()) return;
+
+    if (!initialized && message.value("method").toString() != "initialize") {
+        outgoingQueue.append(message);
+        return;
+    }
+
+    const QByteArray body = QJsonDocument(message).toJson(QJsonDocument::Compact);
+    process->write("Content-Length: " + QByteArray::number(body.size()) + "\r\n\r\n");
+    process->write(body);
+}
+
+void LspClient::sendNotification(const QString &method, const QJsonObject &params)
+{
+    sendMessage(QJsonObject{{"jsonrpc", "2.0"}, {"method", method}, {"params", params}});
+}
+
+int LspClient::sendRequest(const QString &method, const QJsonObject &params, const PendingRequest &context)
+{
+    const int id = nextRequestId++;
+    inFlight.insert(id, context);
+    if (context.kind != Initialize)
+        latestRequest.insert(qMakePair(context.doc, int(context.kind)), id);
+
+    sendMessage(QJsonObject{{"jsonrpc", "2.0"}, {"id", id}, {"method", method}, {"params", params}});
+    return id;
+}
+
+void LspClient::onReadyRead()
+{
+    readBuffer += process->readAllStandardOutput();
+
+    while (true) {
+        const int headerEnd = readBuffer.indexOf("\r\n\r\n");
+        if (headerEnd < 0) return;
+
+        int contentLength = -1;
+        const QList<QByteArray> headers = readBuffer.left(headerEnd).split('\n');
+        for (const QByteArray &header : headers) {
+            const QByteArray line = header.trimmed();
+            if (line.toLower().startsWith("content-length:"))
+                contentLength = line.mid(15).trimmed().toInt();
+        }
+        if (contentLength < 0) {
+            // 无法识别的头部，丢弃后继续
+            readBuffer.remove(0, headerEnd + 4);
+            continue;
+        }
+
+        const int total = headerEnd + 4 + contentLength;
+        if (readBuffer.size() < total) return;
+
+        const QJsonDocument doc = QJsonDocument::fromJson(readBuffer.mid(headerEnd + 4, contentLength));
+        readBuffer.remove(0, total);
+        if (doc.isObject())
+            handleMessage(doc.object());
+    }
+}
+
+void LspClient::handleMessage(const QJsonObject &message)
+{
+    const QString method = message.value("method").toString();
+
+    if (method.isEmpty()) {
+        // 响应：过期或已取消的请求直接丢弃
+        const int id = message.value("id").toInt();
+        if (!inFlight.contains(id)) return;
+        const PendingRequest context = inFlight.take(id);
+
+        const auto key = qMakePair(context.doc, int(context.kind));
+        if (latestRequest.value(key) == id)
+            latestRequest.remove(key);
+
+        if (context.kind != Initialize) {
+            if (!documents.contains(context.doc)) return;
+            if (documents.value(context.doc).version != context.version) return;
+        }
+        if (message.contains("error")) return;
+
+        handleResponse(context, message);
+        return;
+    }
+
+    if (message.contains("id")) {
+        handleServerRequest(method, message);
+        return;
+    }
+
+    if (method == "textDocument/publishDiagnostics")
+        handleDiagnostics(message.value("params").toObject());
+}
+
+void LspClient::handleServerRequest(const QString &method, const QJsonObject &message)
+{
+    // 服务器发起的请求：按协议回复各自的默认结果，不认识的回 MethodNotFound
+    QJsonObject reply{{"jsonrpc", "2.0"}, {"id", message.value("id")}};
+    const QJsonObject params = message.value("params").toObject();
+    if (method == "workspace/configuration") {
+        // 每一项都没有额外配置
+        QJsonArray results;
+        for (int i = 0; i < params.value("items").toArray().size(); ++i)
+            results.append(QJsonValue());
+        reply.insert("result", results);
+    } else if (method == "workspace/workspaceFolders") {
+        QJsonArray folders;
+        if (!workspaceRoot.isEmpty()) {
+            folders.append(QJsonObject{
+                {"uri", QUrl::fromLocalFile(workspaceRoot).toString(QUrl::FullyEncoded)},
+                {"name", QFileInfo(workspaceRoot).fileName()}});
+        }
+        reply.insert("result", folders);
+    } else if (method == "workspace/applyEdit") {
+        reply.insert("result", QJsonObject{{"applied", false}, {"failureReason", "不支持"}});
+    } else if (method == "window/workDoneProgress/create" || method == "client/registerCapability"
+               || method == "client/unregisterCapability" || method == "window/showMessageRequest"
+               || method == "workspace/semanticTokens/refresh" || method == "workspace/diagnostic/refresh") {
+        reply.insert("result", QJsonValue());
+    } else {
+        reply.insert("error", QJsonObject{{"code", -32601}, {"message", "Method not found: " + method}});
+    }
+    sendMessage(reply);
+}
+
+void LspClient::handleResponse(const PendingRequest &context, const QJsonObject &message)
+{
+    const QJsonValue result = message.value("result");
+
+    switch (context.kind) {
+    case Initialize: {
+        const QJsonObject capabilities = result.toObject().value("capabilities").toObject();
+        if (capabilities.isEmpty()) return;   // shutdown 的回复
+
+        semanticTokenTypes.clear();
+        const QJsonArray types = capabilities.value("semanticTokensProvider").toObject()
+                                     .value("legend").toObject()
+                                     .value("tokenTypes").toArray();
+        for (const QJsonValue &type : types)
+            semanticTokenTypes.append(type.toString());
+
+        initialized = true;
+        sendNotification("initialized", QJsonObject());
+        const QList<QJsonObject> queued = outgoingQueue;
+        outgoingQueue.clear();
+        for (const QJsonObject &queuedMessage : queued)
+            sendMessage(queuedMessage);
+        break;
+    }
+
+    case Completion: {
+        const QJsonArray items = result.isArray() ? result.toArray()
+                                                  : result.toObject().value("items").toArray();
+        QStringList words;
+        for (const QJsonValue &value : items) {
+            const QJsonObject item = value.toObject();
+            QString word = item.value("textEdit").toObject().value("newText").toString();
+            if (word.isEmpty()) word = item.value("insertText").toString();
+            if (word.isEmpty()) word = item.value("label").toString().trimmed();
+            if (!word.isEmpty() && !words.contains(word))
+                words.append(word);
+        }
+        emit completionReady(context.doc, context.position, words);
+        break;
+    }
+
+    case Hover: {
+        const QJsonValue contents = result.toObject().value("contents");
+        QString text;
+        if (contents.isObject()) {
+            text = contents.toObject().value("value").toString();
+        } else if (contents.isString()) {
+            text = contents.toString();
+        } else if (contents.isArray()) {
+            QStringList parts;
+            for (const QJsonValue &part : contents.toArray())
+                parts << (part.isObject() ? part.toObject().value("value").toString() : part.toString());
+            text = parts.join("\n");
+        }
+        text = text.trimmed();
+        if (!text.isEmpty())
+            emit hoverReady(context.doc, context.globalPos, text);
+        break;
+    }
+
+    case SemanticTokens: {
+        const QJsonArray data = result.toObject().value("data").toArray();
+        QVector<SemanticToken> tokens;
+        tokens.reserve(data.size() / 5);
+
+        int line = 0;
+        int column = 0;
+        for (int i = 0; i + 4 < data.size(); i += 5) {
+            const int deltaLine = data[i].toInt();
+            const int deltaStart = data[i + 1].toInt();
+            if (deltaLine) {
+                line += deltaLine;
+                column = deltaStart;
+            } else {
+                column += deltaStart;
+            }
+
+            SemanticToken token;
+            token.line = line;
+            token.column = column;
+            token.length = data[i + 2].toInt();
+            token.type = semanticTokenTypes.value(data[i + 3].toInt());
+            tokens.append(token);
+        }
+        emit semanticTokensReady(context.doc, tokens);
+        break;
+    }
+    }
+}
+
+void LspClient::handleDiagnostics(const QJsonObject &params)
+{
+    QTextDocument *doc = documentForUri(params.value("uri").toString());
+    if (!doc) return;
+
+    // 带版本号的诊断若不是针对当前文本，说明已经过期
+    if (params.contains("version") &&
+        params.value("version").toInt() != documents.value(doc).version)
+        return;
+
+    QList<Diagnostic> diagnostics;
+    for (const QJsonValue &value : params.value("diagnostics").toArray()) {
+        const QJsonObject item = value.toObject();
+        const QJsonObject range = item.value("range").toObject();
+        const QJsonObject start = range.value("start").toObject();
+        const QJsonObject end = range.value("end").toObject();
+
+        Diagnostic diagnostic;
+        diagnostic.line = start.value("line").toInt();
+        diagnostic.column = start.value("character").toInt();
+        diagnostic.endLine = end.value("line").toInt();
+        diagnostic.endColumn = end.value("character").toInt();
+        diagnostic.severity = item.value("severity").toInt(Diagnostic::Error);
+        diagnostic.message = item.value("message").toString();
+        diagnostic.source = item.value("source").toString("clangd");
+        diagnostics.append(diagnostic);
+    }
+
+    emit diagnosticsReady(doc, diagnostics);
+}
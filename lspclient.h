@@ -0,0 +1,123 @@
+#ifndef LSPCLIENT_H
+#define LSPCLIENT_H
+
+#include <QObject>
+#include <QProcess>
+#include <QHash>
+#include <QMap>
+#include <QPoint>
+#include <QTimer>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QStringList>
+#include <QTextDocument>
+#include "diagnostic.h"
+#include "CppHighlighter.h"
+
+// ----------------------------------------------------------------------
+// LspClient：通过 stdio 与本地 clangd 通信
+// 文档变更以增量 didChange 发送（来自 QTextDocument::contentsChange），
+// 请求经过防抖，新请求会取消旧请求，过期的回复直接丢弃，输入永远不等待服务器。
+class LspClient : public QObject
+{
+    Q_OBJECT
+public:
+    explicit LspClient(QObject *parent = nullptr);
+    ~LspClient();
+
+    static QString findServer();                  // 查找本机 clangd，找不到返回空
+
+    bool start(const QString &rootPath);
+    void stop();
+    bool isRunning() const;
+    QString rootPath() const { return workspaceRoot; }
+
+    void openDocument(QTextDocument *doc, const QString &filePath);
+    void closeDocument(QTextDocument *doc);
+    bool hasDocument(QTextDocument *doc) const { return documents.contains(doc); }
+
+    void requestCompletion(QTextDocument *doc, int position);
+    void requestHover(QTextDocument *doc, int position, const QPoint &globalPos);
+    void requestSemanticTokens(QTextDocument *doc);
+
+signals:
+    void diagnosticsReady(QTextDocument *doc, const QList<Diagnostic> &diagnostics);
+    void completionReady(QTextDocument *doc, int position, const QStringList &items);
+    void hoverReady(QTextDocument *doc, const QPoint &globalPos, const QString &text);
+    void semanticTokensReady(QTextDocument *doc, const QVector<SemanticToken> &tokens);
+
+private slots:
+    void onReadyRead();
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onDocumentDestroyed(QObject *obj);
+    void flushChanges();
+    void refreshSemanticTokens();
+    void sendScheduledRequests();
+
+private:
+    enum RequestKind { Initialize, Completion, Hover, SemanticTokens };
+
+    struct DocumentState
+    {
+        QString uri;
+        QString shadow;             // 服务器所见的文本，用于计算被删除区间的行列
+        int version = 0;
+        QJsonArray pendingChanges;  // 尚未发送的增量
+        bool tokensStale = false;   // 改动后还没重新请求语义高亮
+    };
+
+    struct PendingRequest
+    {
+        RequestKind kind = Completion;
+        QTextDocument *doc = nullptr;
+        int version = 0;
+        int position = 0;
+        QPoint globalPos;
+    };
+
+    // 防抖中的请求（同类只保留最新一个）
+    struct ScheduledRequest
+    {
+        bool pending = false;
+        QTextDocument *doc = nullptr;
+        int position = 0;
+        QPoint globalPos;
+    };
+
+    void sendMessage(const QJsonObject &message);
+    void sendNotification(const QString &method, const QJsonObject &params);
+    int sendRequest(const QString &method, const QJsonObject &params, const PendingRequest &context);
+    void cancelInFlight(QTextDocument *doc, RequestKind kind);
+    void handleMessage(const QJsonObject &message);
+    void handleServerRequest(const QString &method, const QJsonObject &message);
+    void handleResponse(const PendingRequest &context, const QJsonObject &message);
+    void handleDiagnostics(const QJsonObject &params);
+    void flushDocument(QTextDocument *doc);
+    void sendDidOpen(QTextDocument *doc, DocumentState &state);   // 也用于服务器重启后重新登记
+
+    QJsonObject positionObject(QTextDocument *doc, int position) const;
+    QJsonObject textDocumentId(QTextDocument *doc) const;
+    QTextDocument *documentForUri(const QString &uri) const;
+    static QString documentText(QTextDocument *doc, int position, int length);
+
+    QProcess *process = nullptr;
+    QString workspaceRoot;
+    QByteArray readBuffer;
+    bool initialized = false;
+    QList<QJsonObject> outgoingQueue;          // initialize 完成前缓存的消息
+
+    int nextRequestId = 1;
+    QHash<int, PendingRequest> inFlight;       // id -> 上下文
+    QMap<QPair<QTextDocument*, int>, int> latestRequest; // (文档, 类型) -> 最新请求 id
+
+    QHash<QTextDocument*, DocumentState> documents;
+    QStringList semanticTokenTypes;
+
+    QTimer changeTimer;                        // didChange 防抖
+    QTimer semanticTimer;                      // 语义高亮等输入停顿后再整篇请求
+    QTimer requestTimer;                       // 补全/悬停防抖
+    ScheduledRequest scheduledCompletion;
+    ScheduledRequest scheduledHover;
+};
+
+#endif // LSPCLIENT_H
@@ -1,10 +1,18 @@
 #include "mainwindow.h"
+#include "fontservice.h"
+#include "startupprofiler.h"
 #include <QApplication>
 #include <QStyleFactory>
 #include <qmenu.h>
 int main(int argc, char *argv[])
 {
+    StartupProfiler::instance()->start();
+
     QApplication a(argc, argv);
+    StartupProfiler::instance()->mark("QApplication");
+
+    // 字体在后台注册，与主窗口的构建并行
+    FontService::instance()->loadFonts();
     QPalette pal = a.palette();
 
 
@@ -50,11 +58,14 @@ int main(int argc, char *argv[])
 
 
     a.setPalette(pal);
+    StartupProfiler::instance()->mark("全局样式表");
 
 
 
     MainWindow w;
     w.setWindowTitle("CIDE - Orion++");
+    StartupProfiler::instance()->mark("主窗口构建");
+    StartupProfiler::instance()->watchFirstPaint(&w);
     w.showMaximized(); // 打开时全屏显示，但保留窗口装饰
     w.show();
 
@@ -8,11 +8,26 @@
 #include <QWidget>
 #include <QProcess>
 #include "codeeditor.h"
+#include "lspclient.h"
+#include "textfile.h"
+#include "recoveryjournal.h"
+#include "conversationhistory.h"
 #include <QFileSystemModel>
-#include <QNetworkAccessManager>
 #include <QJsonArray>
 #include <QAction>
 #include <QSettings>
+#include <QSet>
+
+class AiClient;
+struct AiContext;
+class DebugSession;
+class FileSaver;
+class QDockWidget;
+class QPushButton;
+class SyntaxChecker;
+class QFileSystemWatcher;
+class QLabel;
+class QTimer;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class mainWindow; }
@@ -35,6 +50,7 @@ private slots:
     void setupUI();
     void setupEditor(CodeEditor *editor);
     void setupWelcomeTab();
+    void setupDebugger();
 
     // ==================== 文件操作 ====================
     void newFile();
@@ -43,10 +59,17 @@ private slots:
     void openFile();
     void saveFile();
     void saveFileAs();
+    void saveAllFiles();
+    void onFileSaved(const QString &path, const QString &text, const QString &error);
     void exitApp();
     void chooseProjectDirectory(const QString &defaultPath = "");
+    void loadProject(const QString &dir);
     void createProject();
     void onEditorTextChanged();
+
+    // ==================== 分栏 ====================
+    void splitEditor(Qt::Orientation orientation);
+    void closeSplit();
     void updateTabTitle(QWidget *tab, bool modified);
 
     // ==================== 编辑操作 ====================
@@ -62,6 +85,12 @@ private slots:
     void runCurrentFile();
     QStringList collectSourceFiles(const QString &dirPath);
 
+    // ==================== 调试 ====================
+    void startOrContinueDebugging();
+    void stopDebugging();
+    void toggleBreakpointAtCursor();
+    void onDebugStopped(const QString &file, int line, const QString &function, const QString &reason);
+
     // ==================== 标签页管理 ====================
     void showTabContextMenu(const QPoint &pos);
     void renameTabFile(int index);
@@ -71,8 +100,14 @@ private slots:
     void checkEnterPressed();
     void sendToAI(const QString &userText);
     void clearConversationHistory();
+    void showAISettings();
     //用户手册
     void showHelp();
+    void showPerformanceInfo();
+
+    // ==================== 会话 ====================
+    void saveSession();
+    void restoreSession();
 
 private:
     Ui::mainWindow *ui;
@@ -81,24 +116,69 @@ private:
     // ==================== 编辑器管理 ====================
     CodeEditor* createEditor(QWidget *parent);
     CodeEditor* currentEditor();
+    QList<CodeEditor*> editorsForDocument(QTextDocument *doc) const;
     QMap<QWidget*, QString> tabFilePaths;    // 存储每个 tab 对应的文件路径
     QMap<QWidget*, QString> tabSavedContent; // tab -> 上次保存的文本
+    QMap<QWidget*, TextFormat> tabFormats;   // tab -> 打开时检测到的编码与换行
+    QLabel *formatLabel = nullptr;           // 状态栏：当前标签页的编码与换行
+    void setTabFormat(QWidget *tab, const TextFormat &format);
+    void updateFormatLabel();
+    FileSaver *fileSaver = nullptr;          // 后台原子保存
+
+    // ==================== 外部修改检测 ====================
+    QFileSystemWatcher *fileWatcher = nullptr;
+    QTimer *reloadTimer = nullptr;
+    QSet<QString> pendingReloads;
+    void watchFile(const QString &path);
+    void reloadChangedFiles();
+    void reloadTab(QWidget *tab, const QString &content, const TextFormat &format);
+    void handleRemovedFile(const QString &path, const QList<QWidget*> &tabs);
+
+    // ==================== 崩溃恢复 ====================
+    RecoveryJournal *recoveryJournal = nullptr;
+    void recoverUnsavedFiles(const QList<RecoveredFile> &files);
+    CodeEditor *createUntitledTab(const QString &title);
+    bool sessionRestored = false;        // 恢复之前就退出时不覆盖上次的会话
 
     // ==================== 进程和路径管理 ====================
     QProcess *process = nullptr;         // 用于编译和运行
     QString inputLine;
     QString currentFilePath;
     QString currentProjectPath;   // 当前项目根目录
+    bool buildProgram(const QString &exePath, const QStringList &extraFlags);
+    QString compilerPath() const;
+    QProcessEnvironment compilerEnvironment() const;
+
+    // ==================== 后台语法检查 ====================
+    SyntaxChecker *syntaxChecker = nullptr;   // 没有 clangd 时用编译器检查
+    bool compilerMissingReported = false;     // 没有编译器的提示只显示一次
+    void requestSyntaxCheck(CodeEditor *editor, bool immediate);
+
+    // ==================== 调试器 ====================
+    DebugSession *debugSession = nullptr;
+    QDockWidget *debugDock = nullptr;
+    QString filePathForEditor(CodeEditor *editor) const;
+    CodeEditor *showFile(const QString &filePath);   // 已打开则切换过去，否则打开
+    void clearExecutionLine();
 
     // ==================== 查找功能 ====================
     QString lastSearchText;
     QList<QTextCursor> searchResults;
     int currentResultIndex = -1;
 
-    // ==================== 项目模型和网络 ====================
+    // ==================== 项目模型与对话 ====================
     QFileSystemModel* projectModel = nullptr;
-    QNetworkAccessManager *manager;
-    QJsonArray conversationHistory; // 保存多轮对话历史
+    ConversationHistory conversation;   // 多轮对话，按 token 预算裁剪
+    bool gatheringContext = false;      // AI 改代码正在后台收集上下文
+    void requestCodeImprovement(CodeEditor *editor, const AiContext &context);
+    QPushButton *aiStopButton = nullptr;
+    bool aiClientConnected = false;
+    AiClient *aiClient();                // 第一次用到时才创建并接上“停止生成”
+
+    // ==================== 语言服务器 ====================
+    LspClient *lspClient = nullptr;
+    bool lspUnavailable = false;         // 本机没有 clangd 时不再重复查找
+    void attachLanguageServer(CodeEditor *editor, const QString &filePath);
 };
 
 #endif // MAINWINDOW_H
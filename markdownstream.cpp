@@ -0,0 +1,139 @@
+#include "markdownstream.h"
+
+#include <QScreen>
+#include <QScrollBar>
+#include <QTextBlock>
+#include <QTextDocument>
+#include <QTextDocumentFragment>
+#include <QTextEdit>
+#include <QTimer>
+
+namespace {
+QTextDocumentFragment markdownFragment(const QString &markdown)
+{
+    QTextDocument document;
+    document.setMarkdown(markdown);
+    return QTextDocumentFragment(&document);
+}
+
+bool isFence(QStringView line)
+{
+    const QStringView trimmed = line.trimmed();
+    return trimmed.startsWith(u"```") || trimmed.startsWith(u"~~~");
+}
+}
+
+MarkdownStreamRenderer::MarkdownStreamRenderer(QTextEdit *view, QObject *parent)
+    : QObject(parent)
+    , view(view)
+{
+    QTextCursor cursor(view->document());
+    cursor.movePosition(QTextCursor::End);
+    if (!cursor.block().text().isEmpty())
+        cursor.insertBlock(QTextBlockFormat(), QTextCharFormat());
+
+    // 在首尾插入时保持不动：后面追加的对话不会被算进本段
+    tailStart = cursor;
+    tailStart.setKeepPositionOnInsert(true);
+    tailEnd = cursor;
+    tailEnd.setKeepPositionOnInsert(true);
+
+    // 一帧最多渲染一次
+    const QScreen *screen = view->screen();
+    const qreal refreshRate = screen ? qMax<qreal>(screen->refreshRate(), 1.0) : 60.0;
+    frameTimer = new QTimer(this);
+    frameTimer->setSingleShot(true);
+    frameTimer->setInterval(qMax(8, qRound(1000.0 / refreshRate)));
+    connect(frameTimer, &QTimer::timeout, this, &MarkdownStreamRenderer::render);
+}
+
+void MarkdownStreamRenderer::append(const QString &delta)
+{
+    if (delta.isEmpty() || finished) return;
+    buffer += delta;
+    if (!frameTimer->isActive()) frameTimer->start();
+}
+
+void MarkdownStreamRenderer::finish()
+{
+    if (finished) return;
+    finished = true;
+    frameTimer->stop();
+    render();
+
+    // 下一条消息另起一行，且不继承代码块等格式
+    if (view) {
+        QTextCursor cursor(view->document());
+        cursor.setPosition(tailEnd.position());
+        cursor.insertBlock(QTextBlockFormat(), QTextCharFormat());
+    }
+}
+
+int MarkdownStreamRenderer::completedBoundary() const
+{
+    // 已固定的部分总是停在代码块之外，从那里开始往后扫完整的行
+    int boundary = committed;
+    bool inFence = false;
+    int lineStart = committed;
+    for (;;) {
+        const int newline = buffer.indexOf('\n', lineStart);
+        if (newline < 0) break;
+        const QStringView line = QStringView(buffer).mid(lineStart, newline - lineStart);
+        if (isFence(line)) {
+            inFence = !inFence;
+            if (!inFence) boundary = newline + 1;   // 代码块闭合
+        } else if (!inFence && line.trimmed().isEmpty()) {
+            boundary = newline + 1;                 // 空行结束段落、列表等
+        }
+        lineStart = newline + 1;
+    }
+    return boundary;
+}
+
+void MarkdownStreamRenderer::render()
+{
+    if (!view) return;
+
+    QScrollBar *bar = view->verticalScrollBar();
+    const bool followTail = bar->value() >= bar->maximum() - 4;   // 用户往上翻看时不强行滚动
+
+    const int boundary = finished ? buffer.size() : completedBoundary();
+
+    QTextCursor cursor(view->document());
+    cursor.setPosition(tailStart.position());
+    cursor.setPosition(tailEnd.position(), QTextCursor::KeepAnchor);
+    cursor.beginEditBlock();
+    cursor.removeSelectedText();   // 上一帧渲染的未完成块
+
+    // 新完成的块渲染后固定，之后不再重排
+    if (boundary > committed) {
+        cursor.insertFragment(markdownFragment(buffer.mid(committed, boundary - committed)));
+        committed = boundary;
+        tailBlockOpen = committed < buffer.size();
+        if (tailBlockOpen)
+            cursor.insertBlock(QTextBlockFormat(), QTextCharFormat());
+        tailStart.setPosition(cursor.position());
+    }
+
+    // 仍在增长的最后一块：每帧重渲染，代价只与这一块的长度有关
+    QString tail = buffer.mid(committed);
+    if (!tail.isEmpty()) {
+        // 上一帧恰好停在块边界时还没有另起一块，先补上，否则会接在已固定的段落后面
+        if (committed > 0 && !tailBlockOpen) {
+            cursor.insertBlock(QTextBlockFormat(), QTextCharFormat());
+            tailStart.setPosition(cursor.position());
+            tailBlockOpen = true;
+        }
+
+        int fences = 0;
+        for (QStringView line : QStringView(tail).split(u'\n')) {
+            if (isFence(line)) ++fences;
+        }
+        if (fences % 2 == 1) tail += "\n```";   // 未闭合的代码块先按闭合显示
+        cursor.insertFragment(markdownFragment(tail));
+    }
+    tailEnd.setPosition(cursor.position());
+    cursor.endEditBlock();
+
+    if (followTail) bar->setValue(bar->maximum());
+}
@@ -0,0 +1,45 @@
+#ifndef MARKDOWNSTREAM_H
+#define MARKDOWNSTREAM_H
+
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTextCursor>
+
+class QTextEdit;
+class QTimer;
+
+// ----------------------------------------------------------------------
+// MarkdownStreamRenderer：把流式返回的 Markdown 增量追加到聊天窗口末尾
+// 已完整的块（空行结束的段落、闭合的代码块）只渲染一次并固定下来；
+// 仍在增长的最后一块每次整体重渲染。增量先缓存，按屏幕刷新率合并成一次界面更新。
+// 只改动自己那一段文档，之前的对话内容保持不动。
+class MarkdownStreamRenderer : public QObject
+{
+    Q_OBJECT
+public:
+    // 从 view 文档的末尾开始输出
+    explicit MarkdownStreamRenderer(QTextEdit *view, QObject *parent = nullptr);
+
+    void append(const QString &delta);
+    void finish();   // 渲染剩余内容（未闭合的代码块按闭合处理）
+
+    const QString &markdown() const { return buffer; }
+
+private slots:
+    void render();
+
+private:
+    int completedBoundary() const;   // buffer 中最后一个可以固定下来的块边界
+
+    QPointer<QTextEdit> view;
+    QTimer *frameTimer = nullptr;
+    QString buffer;                  // 完整的 Markdown 原文
+    int committed = 0;               // buffer 中已固定渲染的长度
+    bool tailBlockOpen = false;      // 已固定内容之后是否已另起一块给未完成块
+    QTextCursor tailStart;           // 未完成块在文档中的范围
+    QTextCursor tailEnd;
+    bool finished = false;
+};
+
+#endif // MARKDOWNSTREAM_H
@@ -0,0 +1,185 @@
+#include "minimap.h"
+#include "codeeditor.h"
+#include "blockdata.h"
+
+#include <QMouseEvent>
+#include <QPainter>
+#include <QTextBlock>
+
+namespace {
+const int kLineHeight = 2;          // 每行占 2 像素（1 像素文字 + 1 像素间隔）
+const int kTileLines = 128;         // 每个图块包含的行数
+const int kRulerWidth = 5;          // 右侧概览标尺宽度
+const QRgb kBackground = qRgb(250, 250, 250);
+
+QRgb dimmed(QRgb color)
+{
+    // 与背景混合，避免缩略图过于刺眼
+    return qRgb((qRed(color) * 3 + qRed(kBackground) * 2) / 5,
+                (qGreen(color) * 3 + qGreen(kBackground) * 2) / 5,
+                (qBlue(color) * 3 + qBlue(kBackground) * 2) / 5);
+}
+}
+
+Minimap::Minimap(CodeEditor *editor)
+    : QWidget(editor), editor(editor)
+{
+    setCursor(Qt::PointingHandCursor);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+    lastBlockCount = editor->blockCount();
+}
+
+void Minimap::setSearchHits(const QList<QTextCursor> &hits)
+{
+    searchHits = hits;
+    update();
+}
+
+// ----------------- 失效管理 -----------------
+void Minimap::markBlockDirty(int blockNumber)
+{
+    dirtyTiles.insert(blockNumber / kTileLines);
+    update();
+}
+
+void Minimap::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    Q_UNUSED(charsRemoved);
+    Q_UNUSED(charsAdded);
+
+    // 行数变化时，变化点之后的行整体平移，相应图块全部作废
+    const int blockCount = editor->blockCount();
+    if (blockCount != lastBlockCount) {
+        const int firstTile = editor->document()->findBlock(position).blockNumber() / kTileLines;
+        for (auto it = tiles.begin(); it != tiles.end();) {
+            if (it.key() >= firstTile)
+                it = tiles.erase(it);
+            else
+                ++it;
+        }
+        lastBlockCount = blockCount;
+    }
+    update();
+}
+
+void Minimap::resizeEvent(QResizeEvent *event)
+{
+    QWidget::resizeEvent(event);
+    tiles.clear();
+    dirtyTiles.clear();
+}
+
+// ----------------- 几何计算 -----------------
+// 缩略图每行对应一个块（折叠的块照常绘制），视口按首尾可见块号换算，
+// 不能用滚动条的值：滚动条以显示行计，折叠区不占行
+int Minimap::scrollOffset() const
+{
+    const int contentHeight = editor->blockCount() * kLineHeight;
+    if (contentHeight <= height()) return 0;
+
+    const int first = editor->firstVisibleBlockNumber();
+    const int span = editor->lastVisibleBlockNumber() - first + 1;
+    const int maxFirst = editor->blockCount() - span;
+    if (maxFirst <= 0) return 0;
+    return int(qint64(qMin(first, maxFirst)) * (contentHeight - height()) / maxFirst);
+}
+
+// ----------------- 图块 -----------------
+const QImage &Minimap::tile(int index)
+{
+    auto it = tiles.find(index);
+    if (it == tiles.end() || dirtyTiles.contains(index)) {
+        if (it == tiles.end())
+            it = tiles.insert(index, QImage(width(), kTileLines * kLineHeight, QImage::Format_RGB32));
+        renderTile(index, it.value());
+        dirtyTiles.remove(index);
+    }
+    return it.value();
+}
+
+void Minimap::renderTile(int index, QImage &image) const
+{
+    if (image.isNull()) return;
+    image.fill(kBackground);
+    const int maxX = image.width() - kRulerWidth - 1;
+
+    QTextBlock block = editor->document()->findBlockByNumber(index * kTileLines);
+    for (int row = 0; row < kTileLines && block.isValid(); ++row, block = block.next()) {
+        const BlockData *data = static_cast<const BlockData*>(block.userData());
+        if (!data) continue;
+
+        QRgb *line = reinterpret_cast<QRgb*>(image.scanLine(row * kLineHeight));
+        for (const BlockData::ColorRun &run : data->colorRuns) {
+            const int x0 = run.start + 2;
+            const int x1 = qMin(run.start + run.length + 2, maxX);
+            if (x0 >= x1) break;
+            const QRgb color = dimmed(run.color);
+            for (int x = x0; x < x1; ++x)
+                line[x] = color;
+        }
+    }
+}
+
+// ----------------- 绘制 -----------------
+void Minimap::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.fillRect(rect(), QColor(kBackground));
+    if (width() <= kRulerWidth || height() <= 0) return;
+
+    const int totalLines = qMax(1, editor->blockCount());
+    const int offset = scrollOffset();
+    const int tileHeight = kTileLines * kLineHeight;
+    const int firstTile = offset / tileHeight;
+    const int lastTile = (offset + height()) / tileHeight;
+
+    for (int t = firstTile; t <= lastTile && t * kTileLines < totalLines; ++t)
+        painter.drawImage(0, t * tileHeight - offset, tile(t));
+
+    // 只保留可见附近的图块，控制内存
+    for (auto it = tiles.begin(); it != tiles.end();) {
+        if (it.key() < firstTile - 2 || it.key() > lastTile + 2)
+            it = tiles.erase(it);
+        else
+            ++it;
+    }
+
+    // 编辑器当前可见区域
+    const int firstVisible = editor->firstVisibleBlockNumber();
+    const int viewTop = firstVisible * kLineHeight - offset;
+    const int viewHeight = (editor->lastVisibleBlockNumber() - firstVisible + 1) * kLineHeight;
+    painter.fillRect(QRect(0, viewTop, width() - kRulerWidth, viewHeight), QColor(0, 0, 0, 28));
+
+    // 概览标尺：按整个文件的比例标出搜索结果和诊断
+    const int rulerX = width() - kRulerWidth;
+    painter.fillRect(QRect(rulerX, 0, kRulerWidth, height()), QColor(238, 238, 238));
+    auto markerY = [&](int line) { return int(qint64(line) * (height() - 2) / totalLines); };
+
+    for (const QTextCursor &hit : searchHits)
+        painter.fillRect(QRect(rulerX, markerY(hit.blockNumber()), kRulerWidth, 2), QColor(230, 180, 0));
+
+    for (const Diagnostic &diagnostic : editor->currentDiagnostics()) {
+        const QColor color = diagnostic.severity == Diagnostic::Error ? QColor(Qt::red)
+                             : diagnostic.severity == Diagnostic::Warning ? QColor(255, 140, 0)
+                                                                           : QColor(Qt::blue);
+        painter.fillRect(QRect(rulerX, markerY(diagnostic.line), kRulerWidth, 3), color);
+    }
+}
+
+// ----------------- 鼠标导航 -----------------
+void Minimap::scrollEditorTo(int y)
+{
+    editor->scrollBlockToCenter((y + scrollOffset()) / kLineHeight);
+}
+
+void Minimap::mousePressEvent(QMouseEvent *event)
+{
+    if (event->button() == Qt::LeftButton)
+        scrollEditorTo(int(event->position().y()));
+}
+
+void Minimap::mouseMoveEvent(QMouseEvent *event)
+{
+    if (event->buttons() & Qt::LeftButton)
+        scrollEditorTo(int(event->position().y()));
+}
@@ -0,0 +1,50 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include <QWidget>
+#include <QImage>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QTextCursor>
+
+class CodeEditor;
+
+// ----------------------------------------------------------------------
+// Minimap：编辑器右侧的缩略图与概览标尺
+// 缩略图由各块缓存的颜色摘要绘制到按行分片的 QImage 图块中，
+// 只有内容变化的块所在图块才会重绘，且只渲染当前可见的图块。
+class Minimap : public QWidget
+{
+    Q_OBJECT
+public:
+    explicit Minimap(CodeEditor *editor);
+
+    static int preferredWidth() { return 110; }
+
+    void setSearchHits(const QList<QTextCursor> &hits);
+
+public slots:
+    void markBlockDirty(int blockNumber);
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void mousePressEvent(QMouseEvent *event) override;
+    void mouseMoveEvent(QMouseEvent *event) override;
+
+private:
+    int scrollOffset() const;           // 文件比小地图高时，缩略图随编辑器滚动
+    void scrollEditorTo(int y);
+    const QImage &tile(int index);
+    void renderTile(int index, QImage &image) const;
+
+    CodeEditor *editor;
+    QHash<int, QImage> tiles;           // 图块序号 -> 图像
+    QSet<int> dirtyTiles;
+    int lastBlockCount = 0;
+    QList<QTextCursor> searchHits;      // QTextCursor 会随编辑自动移动
+};
+
+#endif // MINIMAP_H
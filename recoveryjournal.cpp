@@ -0,0 +1,335 @@
+#include "recoveryjournal.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QLockFile>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextCursor>
+#include <QTextDocument>
+#include <QTimer>
+
+namespace {
+const quint32 kMagic = 0x434a524e;   // "CJRN"
+const quint32 kVersion = 2;          // 2：文件头增加未命名文件的标题
+const int kFlushInterval = 3000;     // 毫秒
+const int kCompactRecords = 2000;    // 增量累计到这么多条后重写为快照
+
+enum RecordType : quint8 { SnapshotRecord = 1, DeltaRecord = 2 };
+
+// 与 QTextDocument::toPlainText 一致的字符替换，保证快照与增量重放结果相同
+void normalizeSeparators(QString &text)
+{
+    for (QChar &c : text) {
+        if (c == QChar::ParagraphSeparator || c == QChar::LineSeparator)
+            c = QLatin1Char('\n');
+        else if (c == QChar::Nbsp)
+            c = QLatin1Char(' ');
+    }
+}
+}
+
+RecoveryJournal::RecoveryJournal(QObject *parent)
+    : QObject(parent)
+{
+    pool.setMaxThreadCount(1);
+
+    flushTimer = new QTimer(this);
+    flushTimer->setSingleShot(true);
+    flushTimer->setInterval(kFlushInterval);
+    connect(flushTimer, &QTimer::timeout, this, &RecoveryJournal::flush);
+
+    QDir().mkpath(directory());
+    instanceLock = new QLockFile(lockPath(QString::number(QCoreApplication::applicationPid())));
+    instanceLock->setStaleLockTime(0);   // 只凭进程是否存在判断
+    instanceLock->tryLock(0);
+}
+
+RecoveryJournal::~RecoveryJournal()
+{
+    pool.waitForDone();
+    delete instanceLock;   // 释放锁；残留的日志留给下次启动恢复
+}
+
+QString RecoveryJournal::directory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/recovery";
+}
+
+QString RecoveryJournal::lockPath(const QString &pid)
+{
+    return QString("%1/%2.lock").arg(directory(), pid);
+}
+
+// ----------------- 跟踪文档 -----------------
+void RecoveryJournal::track(QTextDocument *document, const QString &filePath, const QString &title)
+{
+    if (!document) return;
+    if (entries.contains(document)) {
+        setFilePath(document, filePath);
+        return;
+    }
+
+    Entry entry;
+    entry.filePath = filePath;
+    entry.title = title;
+    // 同号旧进程的日志可能还没处理完，不能覆盖
+    do {
+        entry.journalPath = QString("%1/%2-%3.journal")
+                                .arg(directory())
+                                .arg(QCoreApplication::applicationPid())
+                                .arg(++serial);
+    } while (QFile::exists(entry.journalPath));
+    entry.revision = document->revision();
+    entries.insert(document, entry);
+
+    connect(document, &QTextDocument::contentsChange, this, &RecoveryJournal::onContentsChange);
+    connect(document, &QTextDocument::modificationChanged, this, &RecoveryJournal::onModificationChanged);
+    connect(document, &QObject::destroyed, this, [this, document]() {
+        entries.remove(document);   // 未经 untrack 就销毁（退出时）：保留日志
+    });
+
+    if (document->isModified())
+        activate(entries[document]);
+}
+
+void RecoveryJournal::setFilePath(QTextDocument *document, const QString &filePath)
+{
+    auto it = entries.find(document);
+    if (it == entries.end() || it->filePath == filePath) return;
+    it->filePath = filePath;
+    it->needsSnapshot = true;   // 路径写在文件头，整篇重写
+    it->pending.clear();
+    if (it->active && !flushTimer->isActive()) flushTimer->start();
+}
+
+void RecoveryJournal::untrack(QTextDocument *document)
+{
+    auto it = entries.find(document);
+    if (it == entries.end()) return;
+    discard(it.value());
+    entries.erase(it);
+    disconnect(document, nullptr, this, nullptr);
+}
+
+void RecoveryJournal::discard(Entry &entry)
+{
+    if (entry.active) {
+        const QString path = entry.journalPath;
+        pool.start([path]() { QFile::remove(path); });   // 排在已提交的写入之后
+    }
+    entry.active = false;
+    entry.needsSnapshot = true;
+    entry.pending.clear();
+    entry.records = 0;
+}
+
+// ----------------- 记录修改 -----------------
+void RecoveryJournal::onModificationChanged(bool modified)
+{
+    auto it = entries.find(qobject_cast<QTextDocument*>(sender()));
+    if (it == entries.end()) return;
+
+    if (modified)
+        activate(it.value());
+    else
+        discard(it.value());   // 已保存或撤销回保存时的状态
+}
+
+void RecoveryJournal::activate(Entry &entry)
+{
+    if (entry.active) return;
+    entry.active = true;
+    entry.needsSnapshot = true;
+    if (!flushTimer->isActive()) flushTimer->start();
+}
+
+void RecoveryJournal::onContentsChange(int position, int charsRemoved, int charsAdded)
+{
+    auto *document = qobject_cast<QTextDocument*>(sender());
+    auto it = entries.find(document);
+    if (it == entries.end()) return;
+    Entry &entry = it.value();
+
+    // 高亮等纯格式变化同样触发 contentsChange，但不改变文档版本号
+    const int revision = document->revision();
+    if (charsRemoved == charsAdded && revision == entry.revision) return;
+    entry.revision = revision;
+
+    // 未激活时由 onModificationChanged 安排快照；待写快照会包含这次修改
+    if (!entry.active) return;
+    if (!flushTimer->isActive()) flushTimer->start();
+    if (entry.needsSnapshot) return;
+
+    // 只取插入的文本，代价与插入长度成正比
+    const int end = document->characterCount() - 1;
+    QTextCursor cursor(document);
+    cursor.setPosition(qBound(0, position, end));
+    cursor.setPosition(qBound(0, position + charsAdded, end), QTextCursor::KeepAnchor);
+    QString inserted = cursor.selectedText();
+    normalizeSeparators(inserted);
+
+    // 与上一条合并：连续输入接在后面，退格删掉刚输入的尾巴
+    if (!entry.pending.isEmpty()) {
+        Delta &last = entry.pending.last();
+        const int lastEnd = last.position + last.inserted.size();
+        if (charsRemoved == 0 && position == lastEnd) {
+            last.inserted += inserted;
+            return;
+        }
+        if (inserted.isEmpty() && position + charsRemoved == lastEnd && charsRemoved <= last.inserted.size()) {
+            last.inserted.chop(charsRemoved);
+            return;
+        }
+    }
+
+    Delta delta;
+    delta.position = position;
+    delta.removed = charsRemoved;
+    delta.inserted = inserted;
+    entry.pending.append(delta);
+}
+
+// ----------------- 写盘 -----------------
+void RecoveryJournal::flush()
+{
+    QDir().mkpath(directory());
+
+    for (auto it = entries.begin(); it != entries.end(); ++it) {
+        Entry &entry = it.value();
+        if (!entry.active) continue;
+
+        QByteArray data;
+        QDataStream out(&data, QIODevice::WriteOnly);
+        out.setVersion(QDataStream::Qt_6_0);
+
+        if (entry.needsSnapshot) {
+            // 新日志或压缩：文件头 + 整篇快照，原子替换旧日志
+            out << kMagic << kVersion << entry.filePath << entry.title;
+            out << quint8(SnapshotRecord) << it.key()->toPlainText();
+            entry.needsSnapshot = false;
+            entry.pending.clear();
+            entry.records = 0;
+            const QString path = entry.journalPath;
+            pool.start([path, data]() { rewriteFile(path, data); });
+        } else if (!entry.pending.isEmpty()) {
+            for (const Delta &delta : std::as_const(entry.pending))
+                out << quint8(DeltaRecord) << qint32(delta.position) << qint32(delta.removed) << delta.inserted;
+            entry.records += entry.pending.size();
+            entry.pending.clear();
+            if (entry.records >= kCompactRecords)
+                entry.needsSnapshot = true;
+            const QString path = entry.journalPath;
+            pool.start([path, data]() { appendToFile(path, data); });
+        }
+    }
+}
+
+void RecoveryJournal::flushAll()
+{
+    flushTimer->stop();
+    flush();
+    pool.waitForDone();
+}
+
+void RecoveryJournal::appendToFile(const QString &path, const QByteArray &data)
+{
+    // 日志已不在（被删除）时不凭空建一个没有文件头的日志；下次快照会重建
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::ExistingOnly))
+        file.write(data);
+}
+
+void RecoveryJournal::rewriteFile(const QString &path, const QByteArray &data)
+{
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) return;
+    file.write(data);
+    file.commit();
+}
+
+// ----------------- 恢复 -----------------
+bool RecoveryJournal::replay(const QByteArray &data, RecoveredFile *file)
+{
+    QDataStream in(data);
+    in.setVersion(QDataStream::Qt_6_0);
+
+    quint32 magic = 0;
+    quint32 version = 0;
+    in >> magic >> version >> file->filePath;
+    if (in.status() != QDataStream::Ok || magic != kMagic || version < 1 || version > kVersion)
+        return false;
+    if (version >= 2) in >> file->title;
+
+    bool hasSnapshot = false;
+    while (!in.atEnd()) {
+        quint8 type = 0;
+        in >> type;
+        if (type == SnapshotRecord) {
+            QString text;
+            in >> text;
+            if (in.status() != QDataStream::Ok) break;
+            file->text = text;
+            hasSnapshot = true;
+        } else if (type == DeltaRecord && hasSnapshot) {
+            qint32 position = 0;
+            qint32 removed = 0;
+            QString inserted;
+            in >> position >> removed >> inserted;
+            if (in.status() != QDataStream::Ok) break;   // 崩溃时写了一半的记录
+            position = qBound(0, int(position), int(file->text.size()));
+            removed = qBound(0, int(removed), int(file->text.size()) - position);
+            file->text.replace(position, removed, inserted);
+        } else {
+            break;
+        }
+    }
+    return hasSnapshot;
+}
+
+QList<RecoveredFile> RecoveryJournal::pending()
+{
+    QList<RecoveredFile> files;
+    QDir dir(directory());
+    const QString ownPid = QString::number(QCoreApplication::applicationPid());
+    QHash<QString, bool> orphaned;   // 进程号 → 其日志是否已无人使用
+
+    const QFileInfoList journals = dir.entryInfoList({ "*.journal" }, QDir::Files, QDir::Time);
+    for (const QFileInfo &info : journals) {
+        // 日志名为 <进程号>-<序号>.journal
+        const QString pid = info.completeBaseName().section('-', 0, 0);
+        if (!orphaned.contains(pid)) {
+            if (pid == ownPid) {
+                // 本进程尚未写过日志：同号的是早已退出的旧进程留下的
+                QFile::remove(lockPath(pid));
+                orphaned.insert(pid, true);
+            } else {
+                // 锁仍被持有说明那个实例还在运行，它的日志不能动
+                QLockFile probe(lockPath(pid));
+                probe.setStaleLockTime(0);
+                const bool free = probe.tryLock(0);
+                if (free) probe.unlock();
+                orphaned.insert(pid, free);
+            }
+        }
+        if (!orphaned.value(pid)) continue;
+
+        // 只读不删：用户做出选择之前崩溃或被结束，下次启动仍能恢复
+        QFile file(info.absoluteFilePath());
+        if (file.open(QIODevice::ReadOnly)) {
+            RecoveredFile recovered;
+            recovered.journalPath = info.absoluteFilePath();
+            if (replay(file.readAll(), &recovered))
+                files.append(recovered);
+        }
+    }
+    return files;
+}
+
+void RecoveryJournal::discard(const QStringList &journalPaths)
+{
+    for (const QString &path : journalPaths)
+        QFile::remove(path);
+}
@@ -0,0 +1,94 @@
+#ifndef RECOVERYJOURNAL_H
+#define RECOVERYJOURNAL_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+class QLockFile;
+class QTextDocument;
+class QTimer;
+
+// 上次未正常保存的文件：路径 + 重放日志得到的文本
+struct RecoveredFile
+{
+    QString filePath;            // 未命名文件为空
+    QString title;               // 未命名文件的标签页标题
+    QString text;
+    QString journalPath;         // 来源日志，交给 discard() 删除
+};
+
+// ----------------------------------------------------------------------
+// RecoveryJournal：未保存修改的恢复日志
+// 每个有未保存修改的文档对应一个只追加的日志文件：开头是整篇快照，之后是
+// contentsChange 给出的增量（位置、删除长度、插入文本）。增量先在内存里合并
+// （连续输入、退格合为一条），每隔几秒由单线程池批量追加到磁盘；累计一定条数后
+// 重写为新的快照。每次按键只取插入的那几个字符，开销与文件大小无关。
+// 文档保存（恢复为未修改）或关闭时删除日志；启动时残留的日志即为可恢复的内容，
+// 在用户恢复或明确放弃之前一直留在磁盘上。
+// 每个实例在日志目录持有一个以进程号命名的锁文件，只有锁已失效（进程已退出）的
+// 日志才会被取出，同时运行的另一个实例的日志不受影响。
+class RecoveryJournal : public QObject
+{
+    Q_OBJECT
+public:
+    explicit RecoveryJournal(QObject *parent = nullptr);
+    ~RecoveryJournal();
+
+    // filePath 为空表示未命名文件，此时以 title 记下标签页标题
+    void track(QTextDocument *document, const QString &filePath, const QString &title = QString());
+    void setFilePath(QTextDocument *document, const QString &filePath);   // 另存为、重命名
+    void untrack(QTextDocument *document);   // 关闭标签页：删除日志
+
+    // 立即写出所有待写内容并等待完成（退出前调用）
+    void flushAll();
+
+    // 读出上次留下的日志（只读），应在开始跟踪文档之前调用
+    static QList<RecoveredFile> pending();
+    // 已恢复或用户放弃之后删除对应的日志
+    static void discard(const QStringList &journalPaths);
+
+private slots:
+    void onContentsChange(int position, int charsRemoved, int charsAdded);
+    void onModificationChanged(bool modified);
+    void flush();
+
+private:
+    struct Delta
+    {
+        int position = 0;
+        int removed = 0;
+        QString inserted;
+    };
+
+    struct Entry
+    {
+        QString filePath;
+        QString title;
+        QString journalPath;
+        QVector<Delta> pending;      // 尚未写盘的增量
+        int records = 0;             // 自上次快照以来写出的增量条数
+        int revision = -1;
+        bool active = false;         // 有未保存修改，日志文件存在或即将写出
+        bool needsSnapshot = true;   // 下次写盘时整篇重写
+    };
+
+    void activate(Entry &entry);
+    void discard(Entry &entry);
+    static QString directory();
+    static QString lockPath(const QString &pid);
+    static void appendToFile(const QString &path, const QByteArray &data);
+    static void rewriteFile(const QString &path, const QByteArray &data);
+    static bool replay(const QByteArray &data, RecoveredFile *file);
+
+    QHash<QTextDocument*, Entry> entries;
+    QThreadPool pool;            // 单线程，保证同一日志的写入顺序
+    QTimer *flushTimer = nullptr;
+    QLockFile *instanceLock = nullptr;   // 表明本实例的日志仍在使用
+    int serial = 0;
+};
+
+#endif // RECOVERYJOURNAL_H
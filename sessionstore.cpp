@@ -0,0 +1,56 @@
+#include "sessionstore.h"
+
+#include <QSettings>
+#include <QStandardPaths>
+#include <QVariant>
+
+QString SessionStore::sessionFile()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppConfigLocation) + "/session.ini";
+}
+
+Session SessionStore::load()
+{
+    QSettings settings(sessionFile(), QSettings::IniFormat);
+    Session session;
+    session.projectPath = settings.value("projectPath").toString();
+    session.currentTab = settings.value("currentTab", -1).toInt();
+
+    const int count = settings.beginReadArray("tabs");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+        SessionTab tab;
+        tab.filePath = settings.value("filePath").toString();
+        tab.cursorPosition = settings.value("cursorPosition").toInt();
+        tab.scrollValue = settings.value("scrollValue").toInt();
+        const QVariantList folded = settings.value("foldedLines").toList();
+        for (const QVariant &line : folded)
+            tab.foldedLines.append(line.toInt());
+        if (!tab.filePath.isEmpty())
+            session.tabs.append(tab);
+    }
+    settings.endArray();
+    return session;
+}
+
+void SessionStore::save(const Session &session)
+{
+    QSettings settings(sessionFile(), QSettings::IniFormat);
+    settings.clear();
+    settings.setValue("projectPath", session.projectPath);
+    settings.setValue("currentTab", session.currentTab);
+
+    settings.beginWriteArray("tabs", session.tabs.size());
+    for (int i = 0; i < session.tabs.size(); ++i) {
+        const SessionTab &tab = session.tabs.at(i);
+        settings.setArrayIndex(i);
+        settings.setValue("filePath", tab.filePath);
+        settings.setValue("cursorPosition", tab.cursorPosition);
+        settings.setValue("scrollValue", tab.scrollValue);
+        QVariantList folded;
+        for (int line : tab.foldedLines)
+            folded.append(line);
+        settings.setValue("foldedLines", folded);
+    }
+    settings.endArray();
+}
@@ -0,0 +1,35 @@
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include <QList>
+#include <QString>
+
+// ----------------------------------------------------------------------
+// SessionStore：退出时保存、启动时恢复的会话快照
+// 保存项目路径、打开的标签页及各自的光标位置、滚动位置和折叠状态。
+struct SessionTab
+{
+    QString filePath;
+    int cursorPosition = 0;
+    int scrollValue = 0;
+    QList<int> foldedLines;   // 折叠起始行号（从 0 开始）
+};
+
+struct Session
+{
+    QString projectPath;
+    QList<SessionTab> tabs;
+    int currentTab = -1;
+};
+
+class SessionStore
+{
+public:
+    static Session load();
+    static void save(const Session &session);
+
+private:
+    static QString sessionFile();
+};
+
+#endif // SESSIONSTORE_H
@@ -0,0 +1,152 @@
+#include "sseparser.h"
+
+#include <QIODevice>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <cstring>
+
+namespace {
+const qsizetype kCompactThreshold = 4096;
+}
+
+void SseParser::readFrom(QIODevice *device)
+{
+    const qint64 available = device->bytesAvailable();
+    if (available <= 0) return;
+
+    const qsizetype size = buffer.size();
+    buffer.resize(size + available);
+    const qint64 read = device->read(buffer.data() + size, available);
+    buffer.resize(size + qMax<qint64>(read, 0));
+}
+
+void SseParser::feed(const QByteArray &chunk)
+{
+    buffer.append(chunk);
+}
+
+void SseParser::reset()
+{
+    buffer.resize(0);
+    head = 0;
+    skipLineFeed = false;
+    current = SseEvent();
+    hasData = false;
+}
+
+bool SseParser::next(SseEvent &event)
+{
+    for (;;) {
+        const char *data = buffer.constData();
+        const qsizetype size = buffer.size();
+
+        if (skipLineFeed && head < size) {
+            if (data[head] == '\n') ++head;
+            skipLineFeed = false;
+        }
+
+        // 找行尾：\n、\r\n 或单独的 \r
+        qsizetype end = head;
+        while (end < size && data[end] != '\n' && data[end] != '\r')
+            ++end;
+        if (end >= size) {
+            compact();   // 行还没收完，留在缓冲区里
+            return false;
+        }
+
+        qsizetype nextLine = end + 1;
+        if (data[end] == '\r') {
+            if (nextLine < size) {
+                if (data[nextLine] == '\n') ++nextLine;
+            } else {
+                skipLineFeed = true;
+            }
+        }
+
+        const qsizetype lineStart = head;
+        head = nextLine;
+        if (processLine(data + lineStart, end - lineStart)) {
+            takeEvent(event);
+            return true;
+        }
+    }
+}
+
+bool SseParser::finish(SseEvent &event)
+{
+    if (next(event)) return true;
+
+    // 没有换行结尾的最后一行
+    if (head < buffer.size()) {
+        processLine(buffer.constData() + head, buffer.size() - head);
+        head = buffer.size();
+    }
+    if (!hasData) return false;
+    takeEvent(event);
+    return true;
+}
+
+bool SseParser::processLine(const char *begin, qsizetype length)
+{
+    if (length == 0)
+        return hasData;        // 空行：分发事件（没有 data 的事件按规范丢弃）
+    if (begin[0] == ':')
+        return false;          // 注释 / 心跳
+
+    const char *colon = static_cast<const char *>(std::memchr(begin, ':', size_t(length)));
+    const qsizetype fieldLength = colon ? colon - begin : length;
+    const char *value = colon ? colon + 1 : begin + length;
+    qsizetype valueLength = begin + length - value;
+    if (valueLength > 0 && *value == ' ') {
+        ++value;
+        --valueLength;
+    }
+
+    const QByteArrayView field(begin, fieldLength);
+    if (field == "data") {
+        if (hasData) current.data.append('\n');
+        current.data.append(value, valueLength);
+        hasData = true;
+    } else if (field == "event") {
+        current.event = QByteArray(value, valueLength);
+    } else if (field == "id") {
+        current.id = QByteArray(value, valueLength);
+    }
+    // retry 及未知字段忽略
+    return false;
+}
+
+void SseParser::takeEvent(SseEvent &event)
+{
+    event.event = std::move(current.event);
+    event.data = std::move(current.data);
+    event.id = current.id;   // id 按规范沿用到后续事件
+    current.event = QByteArray();
+    current.data = QByteArray();
+    hasData = false;
+}
+
+void SseParser::compact()
+{
+    // 全部消费完：清空但保留容量；否则已消费部分过半时才前移，摊还 O(1)
+    if (head >= buffer.size()) {
+        buffer.resize(0);
+        head = 0;
+    } else if (head >= kCompactThreshold && head * 2 >= buffer.size()) {
+        buffer.remove(0, head);
+        head = 0;
+    }
+}
+
+QString SseParser::chatDelta(const QByteArray &data)
+{
+    QJsonParseError error;
+    const QJsonDocument doc = QJsonDocument::fromJson(data, &error);
+    if (error.error != QJsonParseError::NoError || !doc.isObject()) return QString();
+
+    const QJsonArray choices = doc.object().value("choices").toArray();
+    if (choices.isEmpty()) return QString();
+    return choices.at(0).toObject().value("delta").toObject().value("content").toString();
+}
@@ -0,0 +1,55 @@
+#ifndef SSEPARSER_H
+#define SSEPARSER_H
+
+#include <QByteArray>
+#include <QString>
+
+class QIODevice;
+
+// 一个完整的 Server-Sent Event；多行 data 以 '\n' 连接
+struct SseEvent
+{
+    QByteArray event;
+    QByteArray data;
+    QByteArray id;
+
+    bool isDone() const { return data == "[DONE]"; }   // OpenAI 兼容接口的结束标记
+};
+
+// ----------------------------------------------------------------------
+// SseParser：增量解析 text/event-stream
+// 网络数据按任意位置切分到达：行可能被截断在两个包之间，CRLF 也可能被拆开。
+// 字节直接从设备读进内部缓冲区，只在已消费部分过半时整体前移一次，
+// 缓冲区容量反复复用，稳定后不再为每个数据包分配内存。
+class SseParser
+{
+public:
+    // 读出 device 当前可读的全部字节（不经中间 QByteArray）
+    void readFrom(QIODevice *device);
+    void feed(const QByteArray &chunk);
+
+    // 取出下一个完整事件；数据不够时返回 false，等下次喂入后再取
+    bool next(SseEvent &event);
+
+    // 流结束：最后一行或最后一个事件缺少结尾空行时也交出来
+    bool finish(SseEvent &event);
+
+    void reset();
+
+    // 从 chat/completions 流式返回的 data 中取出 choices[0].delta.content
+    static QString chatDelta(const QByteArray &data);
+
+private:
+    bool processLine(const char *begin, qsizetype length);   // 遇到空行且有数据时返回 true
+    void takeEvent(SseEvent &event);
+    void compact();
+
+    QByteArray buffer;
+    qsizetype head = 0;          // 尚未消费的起点
+    bool skipLineFeed = false;   // 上一个数据包以 '\r' 结尾，紧随的 '\n' 属于同一个换行
+
+    SseEvent current;            // 正在拼装的事件
+    bool hasData = false;
+};
+
+#endif // SSEPARSER_H
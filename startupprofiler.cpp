@@ -0,0 +1,88 @@
+#include "startupprofiler.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QEvent>
+#include <QTimer>
+#include <QWidget>
+
+StartupProfiler::StartupProfiler(QObject *parent)
+    : QObject(parent)
+{
+}
+
+StartupProfiler *StartupProfiler::instance()
+{
+    // 在 QApplication 构造之前就可能被调用，因此不设父对象，随进程结束
+    static StartupProfiler *profiler = new StartupProfiler;
+    return profiler;
+}
+
+void StartupProfiler::start()
+{
+    timer.start();
+    recorded.clear();
+    firstPaint = -1;
+    interactive = -1;
+}
+
+void StartupProfiler::mark(const QString &phase)
+{
+    if (!timer.isValid()) return;
+    recorded.append({phase, timer.elapsed()});
+}
+
+void StartupProfiler::watchFirstPaint(QWidget *window)
+{
+    if (window) window->installEventFilter(this);
+}
+
+bool StartupProfiler::eventFilter(QObject *watched, QEvent *event)
+{
+    if (event->type() == QEvent::Paint && firstPaint < 0 && timer.isValid()) {
+        firstPaint = timer.elapsed();
+        watched->removeEventFilter(this);
+
+        // 首帧绘制后，事件循环第一次空闲即视为可交互
+        QTimer::singleShot(0, this, [this]() {
+            interactive = timer.elapsed();
+            qDebug().noquote() << summary();
+            emit interactiveReached();
+        });
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+QString StartupProfiler::summary() const
+{
+    QString text = QStringLiteral("Startup timing:");
+    qint64 previous = 0;
+    for (const Phase &phase : recorded) {
+        text += QStringLiteral("\n  %1: %2 ms (+%3 ms)").arg(phase.name).arg(phase.elapsedMs).arg(phase.elapsedMs - previous);
+        previous = phase.elapsedMs;
+    }
+    text += QStringLiteral("\n  first paint: %1 ms").arg(firstPaint);
+    text += QStringLiteral("\n  interactive: %1 ms").arg(interactive);
+    return text;
+}
+
+QString StartupProfiler::toHtml() const
+{
+    QString html = QStringLiteral(
+        "<h2 style='color:#2c3e50;'>启动性能</h2>"
+        "<table cellspacing='0' cellpadding='4' style='border-collapse:collapse;'>"
+        "<tr style='background:#eef4fb;'><th align='left'>阶段</th><th align='right'>累计 (ms)</th><th align='right'>耗时 (ms)</th></tr>");
+
+    qint64 previous = 0;
+    for (const Phase &phase : recorded) {
+        html += QStringLiteral("<tr><td>%1</td><td align='right'>%2</td><td align='right'>%3</td></tr>")
+                    .arg(phase.name.toHtmlEscaped()).arg(phase.elapsedMs).arg(phase.elapsedMs - previous);
+        previous = phase.elapsedMs;
+    }
+    html += QStringLiteral("</table>");
+
+    auto milestone = [](qint64 ms) { return ms < 0 ? QStringLiteral("—") : QStringLiteral("%1 ms").arg(ms); };
+    html += QStringLiteral("<p><b>首次绘制：</b>%1<br><b>可交互：</b>%2</p>")
+                .arg(milestone(firstPaint), milestone(interactive));
+    return html;
+}
@@ -0,0 +1,53 @@
+#ifndef STARTUPPROFILER_H
+#define STARTUPPROFILER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QVector>
+#include <QString>
+
+class QWidget;
+
+// ----------------------------------------------------------------------
+// StartupProfiler：记录启动各阶段耗时
+// main() 一开始调用 start()，各初始化步骤之后调用 mark()；主窗口第一次绘制记为
+// “首次绘制”，随后事件循环第一次空闲记为“可交互”，此时把汇总写入日志。
+class StartupProfiler : public QObject
+{
+    Q_OBJECT
+public:
+    struct Phase
+    {
+        QString name;
+        qint64 elapsedMs;   // 自 start() 起的累计毫秒数
+    };
+
+    static StartupProfiler *instance();
+
+    void start();
+    void mark(const QString &phase);
+    void watchFirstPaint(QWidget *window);
+
+    const QVector<Phase> &phases() const { return recorded; }
+    qint64 firstPaintMs() const { return firstPaint; }
+    qint64 interactiveMs() const { return interactive; }
+
+    QString summary() const;   // 纯文本汇总，供日志使用
+    QString toHtml() const;    // 供“性能信息”对话框显示
+
+signals:
+    void interactiveReached();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    explicit StartupProfiler(QObject *parent = nullptr);
+
+    QElapsedTimer timer;
+    QVector<Phase> recorded;
+    qint64 firstPaint = -1;
+    qint64 interactive = -1;
+};
+
+#endif // STARTUPPROFILER_H
@@ -0,0 +1,167 @@
+#include "syntaxchecker.h"
+
+#include <QFileInfo>
+#include <QRegularExpression>
+
+namespace {
+const int kDebounceMs = 800;   // 输入停顿多久后检查
+}
+
+SyntaxChecker::SyntaxChecker(QObject *parent)
+    : QObject(parent)
+{
+    debounce.setSingleShot(true);
+    debounce.setInterval(kDebounceMs);
+    connect(&debounce, &QTimer::timeout, this, &SyntaxChecker::runScheduled);
+}
+
+SyntaxChecker::~SyntaxChecker()
+{
+    const QList<QTextDocument*> docs = running.keys();
+    for (QTextDocument *doc : docs)
+        cancel(doc);
+}
+
+void SyntaxChecker::setCompiler(const QString &program, const QProcessEnvironment &env)
+{
+    compiler = program;
+    environment = env;
+}
+
+// ----------------- 调度 -----------------
+void SyntaxChecker::schedule(QTextDocument *doc, const QString &filePath)
+{
+    if (!doc || doc->revision() == checkedRevision.value(doc, -1)) return;
+
+    // 只检查正在编辑的文件：换了文档时，之前排队的那个作废
+    scheduledDoc = doc;
+    scheduledPath = filePath;
+    debounce.start();
+}
+
+void SyntaxChecker::runScheduled()
+{
+    debounce.stop();
+    if (scheduledDoc) check(scheduledDoc, scheduledPath);
+    scheduledDoc = nullptr;
+}
+
+void SyntaxChecker::check(QTextDocument *doc, const QString &filePath)
+{
+    if (!doc || compiler.isEmpty()) return;
+    if (scheduledDoc == doc) {
+        debounce.stop();
+        scheduledDoc = nullptr;
+    }
+    cancel(doc);   // 旧的检查已经过时
+    if (!checkedRevision.contains(doc))
+        connect(doc, &QObject::destroyed, this, &SyntaxChecker::onDocumentDestroyed);
+    checkedRevision.insert(doc, doc->revision());
+
+    const QFileInfo info(filePath);
+    const bool isC = info.suffix().compare("c", Qt::CaseInsensitive) == 0;
+    QStringList args{"-fsyntax-only", "-fdiagnostics-color=never",
+                     "-ftabstop=1",   // 列号按字符数给出，不按 Tab 展开后的显示宽度
+                     "-x", isC ? "c" : "c++"};
+    if (!filePath.isEmpty()) {
+        // 从标准输入读时，#include "..." 仍从文件所在目录找
+        args << "-iquote" << info.absolutePath();
+    }
+    args << "-";
+
+    QProcess *process = new QProcess(this);
+    process->setProcessEnvironment(environment);
+    if (!filePath.isEmpty()) process->setWorkingDirectory(info.absolutePath());
+    process->setStandardOutputFile(QProcess::nullDevice());
+    connect(process, &QProcess::finished, this, [this, doc, process]() { finish(doc, process); });
+    connect(process, &QProcess::errorOccurred, this, [this, doc, process](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart) finish(doc, process);
+    });
+
+    Run run;
+    run.process = process;
+    run.revision = doc->revision();
+    running.insert(doc, run);
+
+    process->start(compiler, args);
+    process->write(doc->toPlainText().toUtf8());
+    process->closeWriteChannel();
+}
+
+void SyntaxChecker::cancel(QTextDocument *doc)
+{
+    const Run run = running.take(doc);
+    if (!run.process) return;
+    run.process->disconnect(this);
+    run.process->kill();
+    run.process->deleteLater();
+}
+
+void SyntaxChecker::finish(QTextDocument *doc, QProcess *process)
+{
+    // 已被新的检查取代
+    if (running.value(doc).process != process) return;
+    const Run run = running.take(doc);
+    process->disconnect(this);
+    process->deleteLater();
+
+    // 检查期间文档又改了：行号可能已对不上，等下一次检查
+    if (process->error() == QProcess::FailedToStart || doc->revision() != run.revision) return;
+    emit diagnosticsReady(doc, parseOutput(process->readAllStandardError()));
+}
+
+void SyntaxChecker::onDocumentDestroyed(QObject *obj)
+{
+    QTextDocument *doc = static_cast<QTextDocument*>(obj);
+    cancel(doc);
+    checkedRevision.remove(doc);
+}
+
+// ----------------- 输出解析 -----------------
+QList<Diagnostic> SyntaxChecker::parseOutput(const QByteArray &output)
+{
+    // gcc 与 clang 的文本格式相同：文件:行:列: 级别: 信息
+    static const QRegularExpression diagnosticLine(
+        QStringLiteral("^(.*?):(\\d+):(?:(\\d+):)?\\s*(fatal error|error|warning):\\s*(.*)$"));
+    static const QRegularExpression includedFrom(
+        QStringLiteral("^(?:In file included from|\\s+from)\\s+<stdin>:(\\d+)"));
+
+    QList<Diagnostic> diagnostics;
+    int includeLine = -1;   // 紧接着的那条诊断所属的“In file included from <stdin>:N”
+    const QStringList lines = QString::fromUtf8(output).split('\n');
+    for (QString line : lines) {
+        line.remove('\r');
+
+        const QRegularExpressionMatch include = includedFrom.match(line);
+        if (include.hasMatch()) {
+            includeLine = include.captured(1).toInt() - 1;
+            continue;
+        }
+
+        const QRegularExpressionMatch match = diagnosticLine.match(line);
+        if (!match.hasMatch()) continue;
+
+        Diagnostic diagnostic;
+        diagnostic.source = "gcc";
+        diagnostic.severity = match.captured(4) == "warning" ? Diagnostic::Warning : Diagnostic::Error;
+        if (match.captured(1) == "<stdin>") {
+            diagnostic.line = match.captured(2).toInt() - 1;
+            diagnostic.column = qMax(0, match.captured(3).toInt() - 1);
+            diagnostic.message = match.captured(5);
+            includeLine = -1;
+        } else if (includeLine >= 0 && diagnostic.severity == Diagnostic::Error) {
+            diagnostic.line = includeLine;
+            diagnostic.column = 0;
+            diagnostic.message = QString("%1:%2: %3").arg(QFileInfo(match.captured(1)).fileName(),
+                                                          match.captured(2), match.captured(5));
+            includeLine = -1;
+        } else {
+            includeLine = -1;   // 每条顶层诊断重新开始，不沿用前面的包含关系
+            continue;
+        }
+        diagnostic.endLine = diagnostic.line;
+        diagnostic.endColumn = diagnostic.column;
+        diagnostics.append(diagnostic);
+    }
+    return diagnostics;
+}
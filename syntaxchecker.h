@@ -0,0 +1,62 @@
+#ifndef SYNTAXCHECKER_H
+#define SYNTAXCHECKER_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QTextDocument>
+#include <QTimer>
+#include "diagnostic.h"
+
+// ----------------------------------------------------------------------
+// SyntaxChecker：用编译器的 -fsyntax-only 在后台检查当前文件
+// 未保存的文本经标准输入交给编译器，输入停顿或保存后即可得到错误，不必等完整编译。
+// 每个文档同时只有一次检查：新的检查开始时杀掉旧进程；结果回来时文档已改则丢弃，
+// 界面上只出现最新一次的结果。
+class SyntaxChecker : public QObject
+{
+    Q_OBJECT
+public:
+    explicit SyntaxChecker(QObject *parent = nullptr);
+    ~SyntaxChecker();
+
+    void setCompiler(const QString &program, const QProcessEnvironment &environment);
+    bool isAvailable() const { return !compiler.isEmpty(); }   // 没有编译器时不做检查
+
+    // 输入停顿后检查（防抖，只保留最近编辑的文档）；check 立即检查，用于保存之后
+    void schedule(QTextDocument *doc, const QString &filePath);
+    void check(QTextDocument *doc, const QString &filePath);
+    void cancel(QTextDocument *doc);
+
+    // 只取属于被检查文件（<stdin>）的诊断；头文件中的错误记在包含它的那一行
+    static QList<Diagnostic> parseOutput(const QByteArray &output);
+
+signals:
+    void diagnosticsReady(QTextDocument *doc, const QList<Diagnostic> &diagnostics);
+
+private slots:
+    void runScheduled();
+    void onDocumentDestroyed(QObject *obj);
+
+private:
+    struct Run
+    {
+        QProcess *process = nullptr;
+        int revision = 0;            // 开始检查时的文档修订号
+    };
+
+    void finish(QTextDocument *doc, QProcess *process);
+
+    QString compiler;
+    QProcessEnvironment environment;
+    QHash<QTextDocument*, Run> running;
+    QHash<QTextDocument*, int> checkedRevision;   // 最近一次检查的修订号，格式刷新不重复检查
+
+    QTimer debounce;
+    QPointer<QTextDocument> scheduledDoc;
+    QString scheduledPath;
+};
+
+#endif // SYNTAXCHECKER_H
@@ -0,0 +1,123 @@
+#include <QtTest>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include "aicache.h"
+
+// ----------------------------------------------------------------------
+// AiCache 测试：未命中不能在磁盘上留下条目，空的或损坏的条目按未命中处理。
+class TestAiCache : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void missStaysMiss();
+    void storeThenHit();
+    void rejectsEmptyEntry();
+    void rejectsCorruptEntry();
+    void evictsOldestOverCapacity();
+
+private:
+    static QByteArray keyFor(const QString &prompt);
+    static QString entryPath(const QTemporaryDir &dir, const QByteArray &key);
+};
+
+QByteArray TestAiCache::keyFor(const QString &prompt)
+{
+    return AiCache::key(QUrl("http://127.0.0.1:8080/v1/chat/completions"),
+                        QJsonObject{{"model", "test"}, {"prompt", prompt}});
+}
+
+QString TestAiCache::entryPath(const QTemporaryDir &dir, const QByteArray &key)
+{
+    return dir.filePath(QString::fromLatin1(key) + ".txt");
+}
+
+void TestAiCache::missStaysMiss()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    AiCache cache(dir.path());
+    const QByteArray key = keyFor("hello");
+
+    QString content;
+    QVERIFY(!cache.lookup(key, &content));
+    QVERIFY(!QFile::exists(entryPath(dir, key)));
+    QVERIFY(!cache.lookup(key, &content));
+    QVERIFY(content.isEmpty());
+}
+
+void TestAiCache::storeThenHit()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    AiCache cache(dir.path());
+    const QByteArray key = keyFor("hello");
+
+    cache.store(key, QString::fromUtf8("你好，world"));
+    QString content;
+    QVERIFY(cache.lookup(key, &content));
+    QCOMPARE(content, QString::fromUtf8("你好，world"));
+    QVERIFY(!cache.lookup(keyFor("other"), &content));
+}
+
+void TestAiCache::rejectsEmptyEntry()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    AiCache cache(dir.path());
+    const QByteArray key = keyFor("hello");
+
+    QFile file(entryPath(dir, key));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.close();
+
+    QString content;
+    QVERIFY(!cache.lookup(key, &content));
+    QVERIFY(!QFile::exists(entryPath(dir, key)));
+}
+
+void TestAiCache::rejectsCorruptEntry()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    AiCache cache(dir.path());
+    const QByteArray key = keyFor("hello");
+
+    QFile file(entryPath(dir, key));
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("abc\xff\xfe");   // 不是合法的 UTF-8
+    file.close();
+
+    QString content;
+    QVERIFY(!cache.lookup(key, &content));
+    QVERIFY(!QFile::exists(entryPath(dir, key)));
+}
+
+void TestAiCache::evictsOldestOverCapacity()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    AiCache cache(dir.path());
+    cache.setCapacity(4000);
+
+    // 单条上限是容量的 1/4；写满后最早的条目被淘汰
+    const QString entry(900, QLatin1Char('x'));
+    for (int i = 0; i < 6; ++i) {
+        cache.store(keyFor(QString::number(i)), entry);
+        QTest::qWait(20);   // 让修改时间可区分
+    }
+
+    qint64 total = 0;
+    const QFileInfoList files = QDir(dir.path()).entryInfoList({"*.txt"}, QDir::Files);
+    for (const QFileInfo &info : files)
+        total += info.size();
+    QVERIFY(total <= 4000);
+
+    QString content;
+    QVERIFY(!cache.lookup(keyFor("0"), &content));
+    QVERIFY(cache.lookup(keyFor("5"), &content));
+}
+
+QTEST_GUILESS_MAIN(TestAiCache)
+#include "tst_aicache.moc"
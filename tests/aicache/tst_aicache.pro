@@ -0,0 +1,14 @@
+QT += testlib
+QT -= gui
+
+CONFIG += testcase console c++17
+TARGET = tst_aicache
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_aicache.cpp \
+    ../../aicache.cpp
+
+HEADERS += \
+    ../../aicache.h
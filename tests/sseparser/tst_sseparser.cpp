@@ -0,0 +1,288 @@
+#include <QtTest>
+#include <QBuffer>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QRandomGenerator>
+#include <QTcpServer>
+#include <QTcpSocket>
+#include <QTimer>
+#include <memory>
+#include "sseparser.h"
+
+// ----------------------------------------------------------------------
+// MockSseServer：本机 HTTP 服务器，把事件流按固定大小切成 chunked 编码的块，
+// 块与块之间隔一段时间发出，模拟真实接口的分包和停顿
+class MockSseServer
+{
+public:
+    MockSseServer(const QByteArray &stream, int chunkSize, int delayMs)
+        : stream(stream), chunkSize(chunkSize), delayMs(delayMs)
+    {
+        QObject::connect(&server, &QTcpServer::newConnection, &server, [this]() {
+            while (QTcpSocket *socket = server.nextPendingConnection())
+                serve(socket);
+        });
+    }
+
+    bool listen() { return server.listen(QHostAddress::LocalHost); }
+    QUrl url() const
+    {
+        return QUrl(QString("http://127.0.0.1:%1/v1/chat/completions").arg(server.serverPort()));
+    }
+
+private:
+    void serve(QTcpSocket *socket)
+    {
+        QObject::connect(socket, &QTcpSocket::disconnected, socket, &QObject::deleteLater);
+        auto request = std::make_shared<QByteArray>();
+        QObject::connect(socket, &QTcpSocket::readyRead, socket, [=]() {
+            // 请求头读完（GET 没有正文）就开始回复
+            *request += socket->readAll();
+            if (!request->contains("\r\n\r\n") || socket->property("answered").toBool()) return;
+            socket->setProperty("answered", true);
+            socket->write("HTTP/1.1 200 OK\r\n"
+                          "Content-Type: text/event-stream\r\n"
+                          "Transfer-Encoding: chunked\r\n"
+                          "Connection: close\r\n\r\n");
+
+            auto offset = std::make_shared<int>(0);
+            QTimer *timer = new QTimer(socket);
+            timer->setInterval(delayMs);
+            QObject::connect(timer, &QTimer::timeout, socket, [=]() {
+                if (*offset >= stream.size()) {
+                    timer->stop();
+                    socket->write("0\r\n\r\n");
+                    socket->disconnectFromHost();
+                    return;
+                }
+                const QByteArray chunk = stream.mid(*offset, chunkSize);
+                *offset += chunk.size();
+                socket->write(QByteArray::number(chunk.size(), 16) + "\r\n" + chunk + "\r\n");
+                socket->flush();
+            });
+            timer->start();
+        });
+    }
+
+    QTcpServer server;
+    QByteArray stream;
+    int chunkSize;
+    int delayMs;
+};
+
+// ----------------------------------------------------------------------
+// SseParser 测试：把录下的一段流按任意位置切开后逐段喂入，
+// 结果必须与整段一次喂入完全相同（模拟网络任意分包）；
+// 再经本机模拟服务器按块、带延时地真实走一遍网络。
+class TestSseParser : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void splitAtEveryOffset();
+    void byteByByte();
+    void randomChunks();
+    void missingFinalBlankLine_data();
+    void missingFinalBlankLine();
+    void readFromDevice();
+    void compactsLongStreams();
+    void mockServer_data();
+    void mockServer();
+
+private:
+    static QByteArray recordedStream();
+    static QList<SseEvent> parse(const QList<QByteArray> &chunks);
+    static void verifyRecorded(const QList<SseEvent> &events);
+};
+
+// 覆盖：注释与心跳、CRLF / LF / 单独 CR 换行、多行 data、冒号后无空格、
+// 没有 data 的空事件、id 沿用到后续事件、[DONE] 结束标记
+QByteArray TestSseParser::recordedStream()
+{
+    return QByteArray(
+        ": keep-alive\r\n"
+        "\r\n"
+        "event: message\r\n"
+        "data: {\"choices\":[{\"delta\":{\"content\":\"Hel\"}}]}\r\n"
+        "\r\n"
+        "id: 7\n"
+        "data: line1\n"
+        "data:  line2\n"
+        "retry: 1000\n"
+        "\n"
+        "data:no-space\r"
+        "\r"
+        ": comment\r\n"
+        "data: [DONE]\r\n"
+        "\r\n");
+}
+
+QList<SseEvent> TestSseParser::parse(const QList<QByteArray> &chunks)
+{
+    SseParser parser;
+    QList<SseEvent> events;
+    SseEvent event;
+    for (const QByteArray &chunk : chunks) {
+        parser.feed(chunk);
+        while (parser.next(event))
+            events.append(event);
+    }
+    while (parser.finish(event))
+        events.append(event);
+    return events;
+}
+
+void TestSseParser::verifyRecorded(const QList<SseEvent> &events)
+{
+    QCOMPARE(events.size(), 4);
+
+    QCOMPARE(events.at(0).event, QByteArray("message"));
+    QCOMPARE(SseParser::chatDelta(events.at(0).data), QString("Hel"));
+
+    QCOMPARE(events.at(1).data, QByteArray("line1\n line2"));   // 只去掉冒号后的一个空格
+    QCOMPARE(events.at(1).id, QByteArray("7"));
+    QVERIFY(events.at(1).event.isEmpty());
+
+    QCOMPARE(events.at(2).data, QByteArray("no-space"));
+    QCOMPARE(events.at(2).id, QByteArray("7"));
+
+    QVERIFY(events.at(3).isDone());
+}
+
+void TestSseParser::splitAtEveryOffset()
+{
+    const QByteArray stream = recordedStream();
+    for (int offset = 0; offset <= stream.size(); ++offset) {
+        const QList<SseEvent> events = parse({stream.left(offset), stream.mid(offset)});
+        verifyRecorded(events);
+        if (QTest::currentTestFailed())
+            QFAIL(qPrintable(QString("切分位置 %1").arg(offset)));
+    }
+}
+
+void TestSseParser::byteByByte()
+{
+    const QByteArray stream = recordedStream();
+    QList<QByteArray> chunks;
+    for (char ch : stream)
+        chunks.append(QByteArray(1, ch));
+    verifyRecorded(parse(chunks));
+}
+
+void TestSseParser::randomChunks()
+{
+    const QByteArray stream = recordedStream();
+    QRandomGenerator random(42);
+    for (int round = 0; round < 200; ++round) {
+        QList<QByteArray> chunks;
+        int position = 0;
+        while (position < stream.size()) {
+            const int length = random.bounded(1, 12);
+            chunks.append(stream.mid(position, length));
+            position += length;
+        }
+        verifyRecorded(parse(chunks));
+        if (QTest::currentTestFailed()) return;
+    }
+}
+
+void TestSseParser::missingFinalBlankLine_data()
+{
+    QTest::addColumn<QByteArray>("stream");
+    QTest::newRow("no newline") << QByteArray("data: first\n\ndata: tail");
+    QTest::newRow("LF only") << QByteArray("data: first\n\ndata: tail\n");
+    QTest::newRow("CRLF only") << QByteArray("data: first\r\n\r\ndata: tail\r\n");
+    QTest::newRow("trailing CR") << QByteArray("data: first\r\rdata: tail\r");
+}
+
+void TestSseParser::missingFinalBlankLine()
+{
+    QFETCH(QByteArray, stream);
+    for (int offset = 0; offset <= stream.size(); ++offset) {
+        const QList<SseEvent> events = parse({stream.left(offset), stream.mid(offset)});
+        QCOMPARE(events.size(), 2);
+        QCOMPARE(events.at(0).data, QByteArray("first"));
+        QCOMPARE(events.at(1).data, QByteArray("tail"));
+    }
+}
+
+void TestSseParser::readFromDevice()
+{
+    QByteArray stream = recordedStream();
+    QBuffer device(&stream);
+    QVERIFY(device.open(QIODevice::ReadOnly));
+
+    SseParser parser;
+    parser.readFrom(&device);
+    QList<SseEvent> events;
+    SseEvent event;
+    while (parser.next(event))
+        events.append(event);
+    verifyRecorded(events);
+}
+
+void TestSseParser::compactsLongStreams()
+{
+    // 远超压缩阈值的长流，分包跨过前移缓冲区的时机
+    QByteArray stream;
+    for (int i = 0; i < 2000; ++i)
+        stream += "data: " + QByteArray::number(i) + "\r\n\r\n";
+
+    QList<QByteArray> chunks;
+    for (int position = 0; position < stream.size(); position += 37)
+        chunks.append(stream.mid(position, 37));
+
+    const QList<SseEvent> events = parse(chunks);
+    QCOMPARE(events.size(), 2000);
+    for (int i = 0; i < events.size(); ++i)
+        QCOMPARE(events.at(i).data, QByteArray::number(i));
+}
+
+void TestSseParser::mockServer_data()
+{
+    QTest::addColumn<int>("chunkSize");
+    QTest::addColumn<int>("delayMs");
+    QTest::newRow("1 byte") << 1 << 2;
+    QTest::newRow("3 bytes") << 3 << 5;
+    QTest::newRow("7 bytes") << 7 << 10;
+    QTest::newRow("whole") << 4096 << 0;
+}
+
+void TestSseParser::mockServer()
+{
+    // 与 AiClient 相同的读法：readyRead 时直接从 QNetworkReply 读进解析器，结束时收尾
+    QFETCH(int, chunkSize);
+    QFETCH(int, delayMs);
+    MockSseServer server(recordedStream(), chunkSize, delayMs);
+    QVERIFY(server.listen());
+
+    QNetworkAccessManager manager;
+    QNetworkRequest request(server.url());
+    request.setRawHeader("Accept", "text/event-stream");
+    QNetworkReply *reply = manager.get(request);
+
+    SseParser parser;
+    QList<SseEvent> events;
+    bool finished = false;
+    QObject::connect(reply, &QNetworkReply::readyRead, reply, [&]() {
+        parser.readFrom(reply);
+        SseEvent event;
+        while (parser.next(event))
+            events.append(event);
+    });
+    QObject::connect(reply, &QNetworkReply::finished, reply, [&]() {
+        parser.readFrom(reply);
+        SseEvent event;
+        while (parser.finish(event))
+            events.append(event);
+        finished = true;
+    });
+
+    QTRY_VERIFY_WITH_TIMEOUT(finished, 20000);
+    QCOMPARE(reply->error(), QNetworkReply::NoError);
+    verifyRecorded(events);
+    reply->deleteLater();
+}
+
+QTEST_GUILESS_MAIN(TestSseParser)
+#include "tst_sseparser.moc"
@@ -0,0 +1,14 @@
+QT += testlib network
+QT -= gui
+
+CONFIG += testcase console c++17
+TARGET = tst_sseparser
+
+INCLUDEPATH += ../..
+
+SOURCES += \
+    tst_sseparser.cpp \
+    ../../sseparser.cpp
+
+HEADERS += \
+    ../../sseparser.h
@@ -0,0 +1,231 @@
+#include "textfile.h"
+
+#include <QFile>
+#include <QStringDecoder>
+#include <QStringEncoder>
+#include <QVector>
+
+namespace {
+const qint64 kChunkSize = 64 * 1024;
+
+enum DecodeResult { Decoded, InvalidData, ReadFailed };
+
+QStringDecoder makeDecoder(TextFormat::Encoding encoding)
+{
+    switch (encoding) {
+    case TextFormat::Utf16LE: return QStringDecoder(QStringConverter::Utf16LE);
+    case TextFormat::Utf16BE: return QStringDecoder(QStringConverter::Utf16BE);
+    case TextFormat::Gb18030: return QStringDecoder("GB18030");   // 需要 Qt 带 ICU，否则 isValid() 为 false
+    case TextFormat::Latin1:  return QStringDecoder(QStringConverter::Latin1);
+    case TextFormat::Utf8:    break;
+    }
+    return QStringDecoder(QStringConverter::Utf8);
+}
+
+QStringEncoder makeEncoder(const TextFormat &format)
+{
+    const QStringConverter::Flags flags = format.bom ? QStringConverter::Flag::WriteBom
+                                                     : QStringConverter::Flag::Default;
+    switch (format.encoding) {
+    case TextFormat::Utf16LE: return QStringEncoder(QStringConverter::Utf16LE, flags);
+    case TextFormat::Utf16BE: return QStringEncoder(QStringConverter::Utf16BE, flags);
+    case TextFormat::Gb18030: return QStringEncoder("GB18030", flags);
+    case TextFormat::Latin1:  return QStringEncoder(QStringConverter::Latin1, flags);
+    case TextFormat::Utf8:    break;
+    }
+    return QStringEncoder(QStringConverter::Utf8, flags);
+}
+
+// 从 offset 开始分块解码到 text；counts 依次统计 LF / CRLF / 单独 CR 的个数。
+// strict 时遇到非法字节立即返回 InvalidData，调用方换编码从头再来
+DecodeResult decodeStream(QFile &file, qint64 offset, QStringDecoder &decoder, bool strict,
+                          QString *text, qsizetype counts[3])
+{
+    if (!file.seek(offset)) return ReadFailed;
+    counts[0] = counts[1] = counts[2] = 0;
+
+    text->resize(decoder.requiredSpace(qMax<qint64>(file.size() - offset, 0)));
+    qsizetype written = 0;
+    bool pendingCR = false;
+
+    while (!file.atEnd()) {
+        const QByteArray chunk = file.read(kChunkSize);
+        if (chunk.isEmpty()) return ReadFailed;
+
+        const qsizetype need = written + decoder.requiredSpace(chunk.size());
+        if (need > text->size())
+            text->resize(qMax(need, text->size() + text->size() / 2));
+
+        QChar *begin = text->data() + written;
+        QChar *end = decoder.appendToBuffer(begin, chunk);
+        if (strict && decoder.hasError()) return InvalidData;
+
+        // 换行规整为 '\n'，原地前移；CR 落在块尾时由 pendingCR 跨块配对
+        QChar *out = begin;
+        for (QChar *in = begin; in != end; ++in) {
+            const char16_t c = in->unicode();
+            if (c == u'\r') {
+                if (pendingCR) ++counts[2];
+                pendingCR = true;
+                *out++ = QChar(u'\n');
+                continue;
+            }
+            if (c == u'\n') {
+                if (pendingCR) {
+                    pendingCR = false;
+                    ++counts[1];
+                    continue;        // CRLF 的 LF 已由 CR 输出
+                }
+                ++counts[0];
+            } else if (pendingCR) {
+                pendingCR = false;
+                ++counts[2];
+            }
+            *out++ = *in;
+        }
+        written = out - text->constData();
+    }
+    if (pendingCR) ++counts[2];
+    if (file.error() != QFileDevice::NoError) return ReadFailed;
+
+    text->truncate(written);
+    return Decoded;
+}
+}
+
+TextFormat TextFormat::platformDefault()
+{
+    TextFormat format;
+#ifdef Q_OS_WIN
+    format.lineEnding = CRLF;
+#endif
+    return format;
+}
+
+QString TextFormat::encodingName() const
+{
+    switch (encoding) {
+    case Utf16LE: return "UTF-16 LE";
+    case Utf16BE: return "UTF-16 BE";
+    case Gb18030: return "GB18030";
+    case Latin1:  return "ISO-8859-1";
+    case Utf8:    break;
+    }
+    return bom ? "UTF-8 BOM" : "UTF-8";
+}
+
+QString TextFormat::lineEndingName() const
+{
+    switch (lineEnding) {
+    case CRLF: return "CRLF";
+    case CR:   return "CR";
+    case LF:   break;
+    }
+    return "LF";
+}
+
+bool TextFile::read(const QString &path, QString *text, TextFormat *format, QString *error)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {   // 二进制方式打开，换行自己处理
+        if (error) *error = file.errorString();
+        return false;
+    }
+
+    // ----------------- BOM -----------------
+    TextFormat detected;
+    qint64 offset = 0;
+    QVector<TextFormat::Encoding> candidates;
+    const QByteArray head = file.peek(3);
+    if (head.startsWith("\xEF\xBB\xBF")) {
+        candidates = { TextFormat::Utf8 };
+        offset = 3;
+    } else if (head.startsWith("\xFF\xFE")) {
+        candidates = { TextFormat::Utf16LE };
+        offset = 2;
+    } else if (head.startsWith("\xFE\xFF")) {
+        candidates = { TextFormat::Utf16BE };
+        offset = 2;
+    } else {
+        // 无 BOM：UTF-8 → GB18030 → Latin-1（任意字节都能解码，保存时原样写回）
+        candidates = { TextFormat::Utf8, TextFormat::Gb18030, TextFormat::Latin1 };
+    }
+    detected.bom = offset > 0;
+
+    // ----------------- 解码 -----------------
+    qsizetype counts[3] = { 0, 0, 0 };
+    bool decoded = false;
+    for (int i = 0; i < candidates.size() && !decoded; ++i) {
+        QStringDecoder decoder = makeDecoder(candidates.at(i));
+        if (!decoder.isValid()) continue;
+
+        const bool last = i == candidates.size() - 1;
+        switch (decodeStream(file, offset, decoder, !last, text, counts)) {
+        case Decoded:
+            detected.encoding = candidates.at(i);
+            decoded = true;
+            break;
+        case InvalidData:
+            break;
+        case ReadFailed:
+            if (error) *error = file.errorString();
+            return false;
+        }
+    }
+    if (!decoded) {
+        if (error) *error = "无法识别文件编码";
+        return false;
+    }
+
+    // ----------------- 换行 -----------------
+    // 取出现最多的一种；没有换行时沿用平台习惯
+    const qsizetype lf = counts[0], crlf = counts[1], cr = counts[2];
+    if (lf == 0 && crlf == 0 && cr == 0)
+        detected.lineEnding = TextFormat::platformDefault().lineEnding;
+    else if (crlf >= lf && crlf >= cr)
+        detected.lineEnding = TextFormat::CRLF;
+    else if (cr > lf)
+        detected.lineEnding = TextFormat::CR;
+    else
+        detected.lineEnding = TextFormat::LF;
+
+    if (format) *format = detected;
+    return true;
+}
+
+QByteArray TextFile::encode(const QString &text, const TextFormat &format, QString *error)
+{
+    QStringEncoder encoder = makeEncoder(format);
+    if (!encoder.isValid()) {
+        if (error) *error = "不支持的编码: " + format.encodingName();
+        return QByteArray();
+    }
+
+    // 一次分配到位，逐行编码直接写进缓冲区，换行在写出时还原
+    const qsizetype extra = format.lineEnding == TextFormat::CRLF ? text.count('\n') : 0;
+    QByteArray data(encoder.requiredSpace(text.size() + extra) + 4, Qt::Uninitialized);   // +4 留给 BOM
+    char *out = data.data();
+
+    if (format.lineEnding == TextFormat::LF) {
+        out = encoder.appendToBuffer(out, text);
+    } else {
+        const QStringView eol = format.lineEnding == TextFormat::CRLF ? QStringView(u"\r\n") : QStringView(u"\r");
+        const QStringView view(text);
+        qsizetype from = 0;
+        for (;;) {
+            const qsizetype newline = view.indexOf(u'\n', from);
+            const qsizetype to = newline < 0 ? view.size() : newline;
+            out = encoder.appendToBuffer(out, view.mid(from, to - from));
+            if (newline < 0) break;
+            out = encoder.appendToBuffer(out, eol);
+            from = newline + 1;
+        }
+    }
+
+    if (encoder.hasError()) {
+        if (error) *error = format.encodingName() + " 编码无法表示文件中的部分字符";
+        return QByteArray();
+    }
+    data.truncate(out - data.constData());
+    return data;
+}
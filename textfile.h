@@ -0,0 +1,39 @@
+#ifndef TEXTFILE_H
+#define TEXTFILE_H
+
+#include <QString>
+
+// 文件的编码与换行格式，打开时检测，保存时原样写回
+struct TextFormat
+{
+    enum Encoding { Utf8, Utf16LE, Utf16BE, Gb18030, Latin1 };
+    enum LineEnding { LF, CRLF, CR };
+
+    Encoding encoding = Utf8;
+    bool bom = false;              // UTF-16 总是带 BOM（只能靠 BOM 识别）
+    LineEnding lineEnding = LF;
+
+    // 新建/未命名文件：UTF-8 无 BOM，换行沿用平台习惯
+    static TextFormat platformDefault();
+
+    QString encodingName() const;     // 状态栏显示，如 "UTF-8 BOM"
+    QString lineEndingName() const;   // "LF" / "CRLF" / "CR"
+};
+
+// ----------------------------------------------------------------------
+// TextFile：流式读取与写出
+// 读取：先看 BOM；没有 BOM 时按 UTF-8 解码并逐块检查错误（Qt 的 UTF-8 解码器自带
+// SSE2/NEON 的 ASCII 快速路径），一旦出错立即改用 GB18030 重读，仍失败则按 Latin-1
+// 原样保留字节。解码直接写进预留好的 QString，换行统计与 CRLF/CR → '\n' 的规整在
+// 同一遍里原地完成，不产生整文件的中间副本。
+class TextFile
+{
+public:
+    // 成功时 text 中的换行统一为 '\n'
+    static bool read(const QString &path, QString *text, TextFormat *format, QString *error = nullptr);
+
+    // 按 format 编码并还原换行；当前编码表示不了的字符会让 error 非空
+    static QByteArray encode(const QString &text, const TextFormat &format, QString *error = nullptr);
+};
+
+#endif // TEXTFILE_H